@@ -3,7 +3,9 @@
 ; 
 ; NOTE: This file is provided as a reference implementation.
 ;       The main application uses compiler intrinsics (SSE2, CPUID) for
-;       cross-compiler compatibility. To use this file instead:
+;       cross-compiler compatibility: check_aes_support lives on as
+;       include/cpu_features.h and the AES-NI rounds as include/aes_ni.h,
+;       both selected at runtime. To use this file instead:
 ;       1. Install MASM (ml64.exe from Visual Studio)
 ;       2. Assemble: ml64 /c crypto_asm.asm
 ;       3. Link: cl Crypt-Vault.cpp crypto_asm.obj
@@ -0,0 +1,278 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════
+// AES-256 Constant-Time Bitsliced Backend
+// Eight blocks per call, no secret-dependent table lookups or
+// branches. The state of four blocks is spread over eight 64-bit
+// words (one word per bit of each byte); with SSE2 two such groups
+// share one register so all eight blocks run in lock-step.
+// S-box: Boyar-Peralta circuit (113 gates).
+// ═══════════════════════════════════════════════════════════
+#include <cstring>
+#include "cpu_features.h"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CRYPTVAULT_BITSLICE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace AESBitslice {
+    typedef unsigned int uint32;
+    typedef unsigned long long uint64;
+    static const size_t BLOCKS = 8;
+
+    // ── Lane operations: one 64-bit word (4 blocks) or SSE2 (8 blocks) ──
+    struct ScalarOps {
+        typedef uint64 W;
+        static W XOR(W a, W b) { return a ^ b; }
+        static W AND(W a, W b) { return a & b; }
+        static W OR(W a, W b) { return a | b; }
+        static W NOT(W a) { return ~a; }
+        static W SHL(W a, int n) { return a << n; }
+        static W SHR(W a, int n) { return a >> n; }
+        static W ROT32(W a) { return (a << 32) | (a >> 32); }
+        static W KEY(uint64 k) { return k; }
+    };
+#ifdef CRYPTVAULT_BITSLICE_SSE2
+    struct Sse2Ops {
+        typedef __m128i W;
+        static W XOR(W a, W b) { return _mm_xor_si128(a, b); }
+        static W AND(W a, W b) { return _mm_and_si128(a, b); }
+        static W OR(W a, W b) { return _mm_or_si128(a, b); }
+        static W NOT(W a) { return _mm_xor_si128(a, _mm_set1_epi32(-1)); }
+        static W SHL(W a, int n) { return _mm_slli_epi64(a, n); }
+        static W SHR(W a, int n) { return _mm_srli_epi64(a, n); }
+        static W ROT32(W a) { return _mm_shuffle_epi32(a, 0xb1); }
+        static W KEY(uint64 k) { return _mm_set1_epi64x((long long)k); }
+    };
+#endif
+
+    template <class O> inline typename O::W maskedShift(typename O::W x, uint64 mask, int shift) {
+        typename O::W m = O::AND(x, O::KEY(mask));
+        return shift >= 0 ? O::SHL(m, shift) : O::SHR(m, -shift);
+    }
+
+    template <class O> inline void sbox(typename O::W* q) {
+        typedef typename O::W W;
+        W x0 = q[7], x1 = q[6], x2 = q[5], x3 = q[4], x4 = q[3], x5 = q[2], x6 = q[1], x7 = q[0];
+        // Top linear transformation
+        W y14 = O::XOR(x3, x5),  y13 = O::XOR(x0, x6),  y9 = O::XOR(x0, x3),   y8 = O::XOR(x0, x5);
+        W t0 = O::XOR(x1, x2),   y1 = O::XOR(t0, x7),   y4 = O::XOR(y1, x3),   y12 = O::XOR(y13, y14);
+        W y2 = O::XOR(y1, x0),   y5 = O::XOR(y1, x6),   y3 = O::XOR(y5, y8),   t1 = O::XOR(x4, y12);
+        W y15 = O::XOR(t1, x5),  y20 = O::XOR(t1, x1),  y6 = O::XOR(y15, x7),  y10 = O::XOR(y15, t0);
+        W y11 = O::XOR(y20, y9), y7 = O::XOR(x7, y11),  y17 = O::XOR(y10, y11), y19 = O::XOR(y10, y8);
+        W y16 = O::XOR(t0, y11), y21 = O::XOR(y13, y16), y18 = O::XOR(x0, y16);
+        // Non-linear section
+        W t2 = O::AND(y12, y15), t3 = O::AND(y3, y6),   t4 = O::XOR(t3, t2),   t5 = O::AND(y4, x7);
+        W t6 = O::XOR(t5, t2),   t7 = O::AND(y13, y16), t8 = O::AND(y5, y1),   t9 = O::XOR(t8, t7);
+        W t10 = O::AND(y2, y7),  t11 = O::XOR(t10, t7), t12 = O::AND(y9, y11), t13 = O::AND(y14, y17);
+        W t14 = O::XOR(t13, t12), t15 = O::AND(y8, y10), t16 = O::XOR(t15, t12), t17 = O::XOR(t4, t14);
+        W t18 = O::XOR(t6, t16), t19 = O::XOR(t9, t14), t20 = O::XOR(t11, t16), t21 = O::XOR(t17, y20);
+        W t22 = O::XOR(t18, y19), t23 = O::XOR(t19, y21), t24 = O::XOR(t20, y18);
+        W t25 = O::XOR(t21, t22), t26 = O::AND(t21, t23), t27 = O::XOR(t24, t26), t28 = O::AND(t25, t27);
+        W t29 = O::XOR(t28, t22), t30 = O::XOR(t23, t24), t31 = O::XOR(t22, t26), t32 = O::AND(t31, t30);
+        W t33 = O::XOR(t32, t24), t34 = O::XOR(t23, t33), t35 = O::XOR(t27, t33), t36 = O::AND(t24, t35);
+        W t37 = O::XOR(t36, t34), t38 = O::XOR(t27, t36), t39 = O::AND(t29, t38), t40 = O::XOR(t25, t39);
+        W t41 = O::XOR(t40, t37), t42 = O::XOR(t29, t33), t43 = O::XOR(t29, t40), t44 = O::XOR(t33, t37);
+        W t45 = O::XOR(t42, t41);
+        W z0 = O::AND(t44, y15), z1 = O::AND(t37, y6),  z2 = O::AND(t33, x7),  z3 = O::AND(t43, y16);
+        W z4 = O::AND(t40, y1),  z5 = O::AND(t29, y7),  z6 = O::AND(t42, y11), z7 = O::AND(t45, y17);
+        W z8 = O::AND(t41, y10), z9 = O::AND(t44, y12), z10 = O::AND(t37, y3), z11 = O::AND(t33, y4);
+        W z12 = O::AND(t43, y13), z13 = O::AND(t40, y5), z14 = O::AND(t29, y2), z15 = O::AND(t42, y9);
+        W z16 = O::AND(t45, y14), z17 = O::AND(t41, y8);
+        // Bottom linear transformation
+        W t46 = O::XOR(z15, z16), t47 = O::XOR(z10, z11), t48 = O::XOR(z5, z13), t49 = O::XOR(z9, z10);
+        W t50 = O::XOR(z2, z12), t51 = O::XOR(z2, z5),   t52 = O::XOR(z7, z8),   t53 = O::XOR(z0, z3);
+        W t54 = O::XOR(z6, z7),  t55 = O::XOR(z16, z17), t56 = O::XOR(z12, t48), t57 = O::XOR(t50, t53);
+        W t58 = O::XOR(z4, t46), t59 = O::XOR(z3, t54),  t60 = O::XOR(t46, t57), t61 = O::XOR(z14, t57);
+        W t62 = O::XOR(t52, t58), t63 = O::XOR(t49, t58), t64 = O::XOR(z4, t59), t65 = O::XOR(t61, t62);
+        W t66 = O::XOR(z1, t63);
+        W s0 = O::XOR(t59, t63), s6 = O::XOR(t56, O::NOT(t62)), s7 = O::XOR(t48, O::NOT(t60));
+        W t67 = O::XOR(t64, t65);
+        W s3 = O::XOR(t53, t66), s4 = O::XOR(t51, t66), s5 = O::XOR(t47, t65);
+        W s1 = O::XOR(t64, O::NOT(s3)), s2 = O::XOR(t55, O::NOT(t67));
+        q[7] = s0; q[6] = s1; q[5] = s2; q[4] = s3; q[3] = s4; q[2] = s5; q[1] = s6; q[0] = s7;
+    }
+
+    // Inverse S-box = A^-1(x ^ 0x63) -> S-box -> A^-1(x ^ 0x63)
+    template <class O> inline void invAffine(typename O::W* q) {
+        typedef typename O::W W;
+        W q0 = O::NOT(q[0]), q1 = O::NOT(q[1]), q2 = q[2], q3 = q[3];
+        W q4 = q[4], q5 = O::NOT(q[5]), q6 = O::NOT(q[6]), q7 = q[7];
+        q[7] = O::XOR(O::XOR(q1, q4), q6);
+        q[6] = O::XOR(O::XOR(q0, q3), q5);
+        q[5] = O::XOR(O::XOR(q7, q2), q4);
+        q[4] = O::XOR(O::XOR(q6, q1), q3);
+        q[3] = O::XOR(O::XOR(q5, q0), q2);
+        q[2] = O::XOR(O::XOR(q4, q7), q1);
+        q[1] = O::XOR(O::XOR(q3, q6), q0);
+        q[0] = O::XOR(O::XOR(q2, q5), q7);
+    }
+    template <class O> inline void invSbox(typename O::W* q) {
+        invAffine<O>(q);
+        sbox<O>(q);
+        invAffine<O>(q);
+    }
+
+    template <class O> inline void shiftRows(typename O::W* q) {
+        for (int i = 0; i < 8; i++) {
+            typename O::W x = q[i];
+            q[i] = O::OR(O::OR(O::OR(O::AND(x, O::KEY(0x000000000000FFFFULL)),
+                                     maskedShift<O>(x, 0x00000000FFF00000ULL, -4)),
+                               O::OR(maskedShift<O>(x, 0x00000000000F0000ULL, 12),
+                                     maskedShift<O>(x, 0x0000FF0000000000ULL, -8))),
+                         O::OR(O::OR(maskedShift<O>(x, 0x000000FF00000000ULL, 8),
+                                     maskedShift<O>(x, 0xF000000000000000ULL, -12)),
+                               maskedShift<O>(x, 0x0FFF000000000000ULL, 4)));
+        }
+    }
+    template <class O> inline void invShiftRows(typename O::W* q) {
+        for (int i = 0; i < 8; i++) {
+            typename O::W x = q[i];
+            q[i] = O::OR(O::OR(O::OR(O::AND(x, O::KEY(0x000000000000FFFFULL)),
+                                     maskedShift<O>(x, 0x000000000FFF0000ULL, 4)),
+                               O::OR(maskedShift<O>(x, 0x00000000F0000000ULL, -12),
+                                     maskedShift<O>(x, 0x000000FF00000000ULL, 8))),
+                         O::OR(O::OR(maskedShift<O>(x, 0x0000FF0000000000ULL, -8),
+                                     maskedShift<O>(x, 0x000F000000000000ULL, 12)),
+                               maskedShift<O>(x, 0xFFF0000000000000ULL, -4)));
+        }
+    }
+
+    template <class O> inline void mixColumns(typename O::W* q) {
+        typedef typename O::W W;
+        W r[8];
+        for (int i = 0; i < 8; i++) r[i] = O::OR(O::SHR(q[i], 16), O::SHL(q[i], 48));
+        W q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3], q4 = q[4], q5 = q[5], q6 = q[6], q7 = q[7];
+        W q7r7 = O::XOR(q7, r[7]);
+        q[0] = O::XOR(O::XOR(q7r7, r[0]), O::ROT32(O::XOR(q0, r[0])));
+        q[1] = O::XOR(O::XOR(O::XOR(q0, r[0]), O::XOR(q7r7, r[1])), O::ROT32(O::XOR(q1, r[1])));
+        q[2] = O::XOR(O::XOR(O::XOR(q1, r[1]), r[2]), O::ROT32(O::XOR(q2, r[2])));
+        q[3] = O::XOR(O::XOR(O::XOR(q2, r[2]), O::XOR(q7r7, r[3])), O::ROT32(O::XOR(q3, r[3])));
+        q[4] = O::XOR(O::XOR(O::XOR(q3, r[3]), O::XOR(q7r7, r[4])), O::ROT32(O::XOR(q4, r[4])));
+        q[5] = O::XOR(O::XOR(O::XOR(q4, r[4]), r[5]), O::ROT32(O::XOR(q5, r[5])));
+        q[6] = O::XOR(O::XOR(O::XOR(q5, r[5]), r[6]), O::ROT32(O::XOR(q6, r[6])));
+        q[7] = O::XOR(O::XOR(O::XOR(q6, r[6]), r[7]), O::ROT32(O::XOR(q7, r[7])));
+    }
+    template <class O> inline typename O::W xorAll(typename O::W a) { return a; }
+    template <class O, class... Rest> inline typename O::W xorAll(typename O::W a, typename O::W b, Rest... rest) {
+        return xorAll<O>(O::XOR(a, b), rest...);
+    }
+    template <class O> inline void invMixColumns(typename O::W* q) {
+        typedef typename O::W W;
+        W r[8];
+        for (int i = 0; i < 8; i++) r[i] = O::OR(O::SHR(q[i], 16), O::SHL(q[i], 48));
+        W q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3], q4 = q[4], q5 = q[5], q6 = q[6], q7 = q[7];
+        q[0] = O::XOR(xorAll<O>(q5, q6, q7, r[0], r[5], r[7]), O::ROT32(xorAll<O>(q0, q5, q6, r[0], r[5])));
+        q[1] = O::XOR(xorAll<O>(q0, q5, r[0], r[1], r[5], r[6], r[7]), O::ROT32(xorAll<O>(q1, q5, q7, r[1], r[5], r[6])));
+        q[2] = O::XOR(xorAll<O>(q0, q1, q6, r[1], r[2], r[6], r[7]), O::ROT32(xorAll<O>(q0, q2, q6, r[2], r[6], r[7])));
+        q[3] = O::XOR(xorAll<O>(q0, q1, q2, q5, q6, r[0], r[2], r[3], r[5]),
+                      O::ROT32(xorAll<O>(q0, q1, q3, q5, q6, q7, r[0], r[3], r[5], r[7])));
+        q[4] = O::XOR(xorAll<O>(q1, q2, q3, q5, r[1], r[3], r[4], r[5], r[6], r[7]),
+                      O::ROT32(xorAll<O>(q1, q2, q4, q5, q7, r[1], r[4], r[5], r[6])));
+        q[5] = O::XOR(xorAll<O>(q2, q3, q4, q6, r[2], r[4], r[5], r[6], r[7]),
+                      O::ROT32(xorAll<O>(q2, q3, q5, q6, r[2], r[5], r[6], r[7])));
+        q[6] = O::XOR(xorAll<O>(q3, q4, q5, q7, r[3], r[5], r[6], r[7]),
+                      O::ROT32(xorAll<O>(q3, q4, q6, q7, r[3], r[6], r[7])));
+        q[7] = O::XOR(xorAll<O>(q4, q5, q6, r[4], r[6], r[7]), O::ROT32(xorAll<O>(q4, q5, q7, r[4], r[7])));
+    }
+
+    template <class O> inline void addRoundKey(typename O::W* q, const uint64* sk) {
+        for (int i = 0; i < 8; i++) q[i] = O::XOR(q[i], O::KEY(sk[i]));
+    }
+
+    template <class O> inline void encryptRounds(typename O::W* q, const uint64* sk, int Nr) {
+        addRoundKey<O>(q, sk);
+        for (int round = 1; round < Nr; round++) {
+            sbox<O>(q); shiftRows<O>(q); mixColumns<O>(q); addRoundKey<O>(q, sk + round*8);
+        }
+        sbox<O>(q); shiftRows<O>(q); addRoundKey<O>(q, sk + Nr*8);
+    }
+    template <class O> inline void decryptRounds(typename O::W* q, const uint64* sk, int Nr) {
+        addRoundKey<O>(q, sk + Nr*8);
+        for (int round = Nr - 1; round > 0; round--) {
+            invShiftRows<O>(q); invSbox<O>(q); addRoundKey<O>(q, sk + round*8); invMixColumns<O>(q);
+        }
+        invShiftRows<O>(q); invSbox<O>(q); addRoundKey<O>(q, sk);
+    }
+
+    // ── Packing: 4 blocks <-> 8 bitsliced words ──
+    inline void swapBits(uint64& x, uint64& y, uint64 lo, uint64 hi, int s) {
+        uint64 a = x, b = y;
+        x = (a & lo) | ((b & lo) << s);
+        y = ((a & hi) >> s) | (b & hi);
+    }
+    inline void ortho(uint64* q) {
+        for (int i = 0; i < 8; i += 2) swapBits(q[i], q[i+1], 0x5555555555555555ULL, 0xAAAAAAAAAAAAAAAAULL, 1);
+        for (int i = 0; i < 8; i += (i & 1) ? 3 : 1)   // 0, 1, 4, 5
+            swapBits(q[i], q[i+2], 0x3333333333333333ULL, 0xCCCCCCCCCCCCCCCCULL, 2);
+        for (int i = 0; i < 4; i++) swapBits(q[i], q[i+4], 0x0F0F0F0F0F0F0F0FULL, 0xF0F0F0F0F0F0F0F0ULL, 4);
+    }
+    inline uint64 spread16(uint32 w) {
+        uint64 x = w;
+        x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+        return (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+    }
+    inline uint32 gather16(uint64 x) {
+        x &= 0x00FF00FF00FF00FFULL;
+        x = (x | (x >> 8)) & 0x0000FFFF0000FFFFULL;
+        return (uint32)x | (uint32)(x >> 16);
+    }
+    inline uint32 load32le(const unsigned char* p) {
+        return (uint32)p[0] | ((uint32)p[1]<<8) | ((uint32)p[2]<<16) | ((uint32)p[3]<<24);
+    }
+    inline void store32le(unsigned char* p, uint32 v) {
+        p[0] = (unsigned char)v; p[1] = (unsigned char)(v>>8); p[2] = (unsigned char)(v>>16); p[3] = (unsigned char)(v>>24);
+    }
+    // blocks: 4 x 16 bytes -> q[8]
+    inline void pack(uint64* q, const unsigned char* blocks) {
+        for (int b = 0; b < 4; b++) {
+            const unsigned char* p = blocks + b*16;
+            q[b]     = spread16(load32le(p))     | (spread16(load32le(p+8)) << 8);
+            q[b + 4] = spread16(load32le(p+4))   | (spread16(load32le(p+12)) << 8);
+        }
+        ortho(q);
+    }
+    inline void unpack(unsigned char* blocks, uint64* q) {
+        ortho(q);
+        for (int b = 0; b < 4; b++) {
+            unsigned char* p = blocks + b*16;
+            store32le(p,      gather16(q[b]));
+            store32le(p + 4,  gather16(q[b + 4]));
+            store32le(p + 8,  gather16(q[b] >> 8));
+            store32le(p + 12, gather16(q[b + 4] >> 8));
+        }
+    }
+
+    // Round keys (FIPS byte layout, Nr+1 x 16 bytes) -> 8 words per round
+    inline void expandKeys(const unsigned char* roundKey, int Nr, uint64* sk) {
+        for (int r = 0; r <= Nr; r++) {
+            unsigned char rep[64];
+            for (int b = 0; b < 4; b++) memcpy(rep + b*16, roundKey + r*16, 16);
+            pack(sk + r*8, rep);
+        }
+    }
+
+    // Process exactly BLOCKS (8) consecutive blocks in place
+    inline void crypt8(const uint64* sk, int Nr, unsigned char* blocks, bool decrypt) {
+        uint64 q[2][8];
+        pack(q[0], blocks);
+        pack(q[1], blocks + 64);
+#ifdef CRYPTVAULT_BITSLICE_SSE2
+        __m128i v[8];
+        for (int i = 0; i < 8; i++) v[i] = _mm_set_epi64x((long long)q[1][i], (long long)q[0][i]);
+        if (decrypt) decryptRounds<Sse2Ops>(v, sk, Nr);
+        else encryptRounds<Sse2Ops>(v, sk, Nr);
+        for (int i = 0; i < 8; i++) {
+            uint64 lanes[2];
+            _mm_storeu_si128((__m128i*)lanes, v[i]);
+            q[0][i] = lanes[0]; q[1][i] = lanes[1];
+        }
+#else
+        for (int g = 0; g < 2; g++) {
+            if (decrypt) decryptRounds<ScalarOps>(q[g], sk, Nr);
+            else encryptRounds<ScalarOps>(q[g], sk, Nr);
+        }
+#endif
+        unpack(blocks, q[0]);
+        unpack(blocks + 64, q[1]);
+    }
+}
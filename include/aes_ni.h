@@ -0,0 +1,110 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════
+// AES-256 Hardware Backend (Intel AES-NI)
+// Key schedule via AESKEYGENASSIST, rounds via AESENC/AESDEC.
+// Round keys use the same byte layout as the portable
+// AES256Impl::Context schedule (15 x 16 bytes).
+// ═══════════════════════════════════════════════════════════
+#include "cpu_features.h"
+#ifdef CRYPTVAULT_X86
+#include <immintrin.h>
+#endif
+
+namespace AESNI {
+    inline bool available() { return CpuFeatures::get().aesni; }
+
+#ifdef CRYPTVAULT_X86
+    CV_TARGET("sse2")
+    inline __m128i shiftXor(__m128i a) {
+        __m128i t = _mm_slli_si128(a, 4);
+        a = _mm_xor_si128(a, t);
+        t = _mm_slli_si128(t, 4);
+        a = _mm_xor_si128(a, t);
+        t = _mm_slli_si128(t, 4);
+        return _mm_xor_si128(a, t);
+    }
+
+    // Even round key: previous even key + RotWord/SubWord/Rcon of previous odd key
+    #define CV_AESNI_EXPAND_EVEN(rk, i, rcon) \
+        rk[i] = _mm_xor_si128(shiftXor(rk[i-2]), \
+                _mm_shuffle_epi32(_mm_aeskeygenassist_si128(rk[i-1], rcon), 0xff))
+    // Odd round key: previous odd key + SubWord of the new even key (no rotation, no Rcon)
+    #define CV_AESNI_EXPAND_ODD(rk, i) \
+        rk[i] = _mm_xor_si128(shiftXor(rk[i-2]), \
+                _mm_shuffle_epi32(_mm_aeskeygenassist_si128(rk[i-1], 0x00), 0xaa))
+
+    // Expand a 256-bit key into 15 encryption round keys plus the
+    // AESIMC-transformed schedule consumed by AESDEC
+    CV_TARGET("aes,sse2")
+    inline void expandKey256(const unsigned char key[32], unsigned char encKeys[240], unsigned char decKeys[240]) {
+        __m128i rk[15];
+        rk[0] = _mm_loadu_si128((const __m128i*)key);
+        rk[1] = _mm_loadu_si128((const __m128i*)(key + 16));
+        CV_AESNI_EXPAND_EVEN(rk,  2, 0x01); CV_AESNI_EXPAND_ODD(rk,  3);
+        CV_AESNI_EXPAND_EVEN(rk,  4, 0x02); CV_AESNI_EXPAND_ODD(rk,  5);
+        CV_AESNI_EXPAND_EVEN(rk,  6, 0x04); CV_AESNI_EXPAND_ODD(rk,  7);
+        CV_AESNI_EXPAND_EVEN(rk,  8, 0x08); CV_AESNI_EXPAND_ODD(rk,  9);
+        CV_AESNI_EXPAND_EVEN(rk, 10, 0x10); CV_AESNI_EXPAND_ODD(rk, 11);
+        CV_AESNI_EXPAND_EVEN(rk, 12, 0x20); CV_AESNI_EXPAND_ODD(rk, 13);
+        CV_AESNI_EXPAND_EVEN(rk, 14, 0x40);
+        for (int i = 0; i < 15; i++)
+            _mm_storeu_si128((__m128i*)(encKeys + i * 16), rk[i]);
+        _mm_storeu_si128((__m128i*)decKeys, rk[14]);
+        for (int i = 1; i < 14; i++)
+            _mm_storeu_si128((__m128i*)(decKeys + i * 16), _mm_aesimc_si128(rk[14 - i]));
+        _mm_storeu_si128((__m128i*)(decKeys + 14 * 16), rk[0]);
+        for (int i = 0; i < 15; i++) rk[i] = _mm_setzero_si128();
+    }
+    #undef CV_AESNI_EXPAND_EVEN
+    #undef CV_AESNI_EXPAND_ODD
+
+    CV_TARGET("aes,sse2")
+    inline void encryptBlock(const unsigned char encKeys[240], unsigned char block[16]) {
+        const __m128i* rk = (const __m128i*)encKeys;
+        __m128i s = _mm_xor_si128(_mm_loadu_si128((const __m128i*)block), _mm_loadu_si128(rk));
+        for (int r = 1; r < 14; r++) s = _mm_aesenc_si128(s, _mm_loadu_si128(rk + r));
+        s = _mm_aesenclast_si128(s, _mm_loadu_si128(rk + 14));
+        _mm_storeu_si128((__m128i*)block, s);
+    }
+
+    CV_TARGET("aes,sse2")
+    inline void decryptBlock(const unsigned char decKeys[240], unsigned char block[16]) {
+        const __m128i* dk = (const __m128i*)decKeys;
+        __m128i s = _mm_xor_si128(_mm_loadu_si128((const __m128i*)block), _mm_loadu_si128(dk));
+        for (int r = 1; r < 14; r++) s = _mm_aesdec_si128(s, _mm_loadu_si128(dk + r));
+        s = _mm_aesdeclast_si128(s, _mm_loadu_si128(dk + 14));
+        _mm_storeu_si128((__m128i*)block, s);
+    }
+
+    // ECB over many independent blocks, 8 in flight so the AESENC/AESDEC
+    // latency (4+ cycles) overlaps instead of serialising each block
+    static const size_t LANES = 8;
+
+    CV_TARGET("aes,sse2")
+    inline void cryptBlocks(const unsigned char keys[240], unsigned char* data, size_t nBlocks, bool decrypt) {
+        const __m128i* rk = (const __m128i*)keys;
+        __m128i k[15];
+        for (int r = 0; r < 15; r++) k[r] = _mm_loadu_si128(rk + r);
+        size_t i = 0;
+        for (; i + LANES <= nBlocks; i += LANES) {
+            __m128i* p = (__m128i*)(data + i * 16);
+            __m128i s[LANES];
+            for (size_t l = 0; l < LANES; l++) s[l] = _mm_xor_si128(_mm_loadu_si128(p + l), k[0]);
+            if (decrypt) {
+                for (int r = 1; r < 14; r++)
+                    for (size_t l = 0; l < LANES; l++) s[l] = _mm_aesdec_si128(s[l], k[r]);
+                for (size_t l = 0; l < LANES; l++) s[l] = _mm_aesdeclast_si128(s[l], k[14]);
+            } else {
+                for (int r = 1; r < 14; r++)
+                    for (size_t l = 0; l < LANES; l++) s[l] = _mm_aesenc_si128(s[l], k[r]);
+                for (size_t l = 0; l < LANES; l++) s[l] = _mm_aesenclast_si128(s[l], k[14]);
+            }
+            for (size_t l = 0; l < LANES; l++) _mm_storeu_si128(p + l, s[l]);
+        }
+        for (; i < nBlocks; i++) {
+            if (decrypt) decryptBlock(keys, data + i * 16);
+            else encryptBlock(keys, data + i * 16);
+        }
+    }
+#endif
+}
@@ -0,0 +1,301 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════
+// Argon2id (RFC 9106) over BLAKE2b (RFC 7693)
+// Memory-hard password hashing: t passes over m KiB split into p
+// lanes. Lanes of one slice are filled on separate threads.
+// ═══════════════════════════════════════════════════════════
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <vector>
+#include <thread>
+
+namespace Argon2Impl {
+    typedef unsigned int uint32;
+    typedef unsigned long long uint64;
+
+    inline uint64 load64le(const unsigned char* p) {
+        uint64 v = 0;
+        for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+        return v;
+    }
+    inline void store64le(unsigned char* p, uint64 v) {
+        for (int i = 0; i < 8; i++) { p[i] = (unsigned char)v; v >>= 8; }
+    }
+    inline void store32le(unsigned char* p, uint32 v) {
+        for (int i = 0; i < 4; i++) { p[i] = (unsigned char)v; v >>= 8; }
+    }
+    inline uint64 rotr64(uint64 x, int n) { return (x >> n) | (x << (64 - n)); }
+    inline void wipe(void* p, size_t len) {
+        volatile unsigned char* v = (volatile unsigned char*)p;
+        while (len--) *v++ = 0;
+    }
+
+    // ─── BLAKE2b, unkeyed, 1..64 byte digests ───
+    class Blake2b {
+        uint64 h[8], t[2];
+        unsigned char buf[128];
+        size_t bufLen;
+        size_t outLen;
+        static const uint64* iv() {
+            static const uint64 IV[8] = {
+                0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+                0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL };
+            return IV;
+        }
+        void compress(const unsigned char* block, bool last) {
+            static const unsigned char SIGMA[12][16] = {
+                { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,15}, {14,10, 4, 8, 9,15,13, 6, 1,12, 0, 2,11, 7, 5, 3},
+                {11, 8,12, 0, 5, 2,15,13,10,14, 3, 6, 7, 1, 9, 4}, { 7, 9, 3, 1,13,12,11,14, 2, 6, 5,10, 4, 0,15, 8},
+                { 9, 0, 5, 7, 2, 4,10,15,14, 1,11,12, 6, 8, 3,13}, { 2,12, 6,10, 0,11, 8, 3, 4,13, 7, 5,15,14, 1, 9},
+                {12, 5, 1,15,14,13, 4,10, 0, 7, 6, 3, 9, 2, 8,11}, {13,11, 7,14,12, 1, 3, 9, 5, 0,15, 4, 8, 6, 2,10},
+                { 6,15,14, 9,11, 3, 0, 8,12, 2,13, 7, 1, 4,10, 5}, {10, 2, 8, 4, 7, 6, 1, 5,15,11, 9,14, 3,12,13, 0},
+                { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,15}, {14,10, 4, 8, 9,15,13, 6, 1,12, 0, 2,11, 7, 5, 3} };
+            uint64 m[16], v[16];
+            for (int i = 0; i < 16; i++) m[i] = load64le(block + i * 8);
+            for (int i = 0; i < 8; i++) { v[i] = h[i]; v[i + 8] = iv()[i]; }
+            v[12] ^= t[0]; v[13] ^= t[1];
+            if (last) v[14] = ~v[14];
+            #define CV_B2B_G(r, i, a, b, c, d) \
+                a = a + b + m[SIGMA[r][2*i]];   d = rotr64(d ^ a, 32); c = c + d; b = rotr64(b ^ c, 24); \
+                a = a + b + m[SIGMA[r][2*i+1]]; d = rotr64(d ^ a, 16); c = c + d; b = rotr64(b ^ c, 63)
+            for (int r = 0; r < 12; r++) {
+                CV_B2B_G(r, 0, v[0], v[4], v[ 8], v[12]); CV_B2B_G(r, 1, v[1], v[5], v[ 9], v[13]);
+                CV_B2B_G(r, 2, v[2], v[6], v[10], v[14]); CV_B2B_G(r, 3, v[3], v[7], v[11], v[15]);
+                CV_B2B_G(r, 4, v[0], v[5], v[10], v[15]); CV_B2B_G(r, 5, v[1], v[6], v[11], v[12]);
+                CV_B2B_G(r, 6, v[2], v[7], v[ 8], v[13]); CV_B2B_G(r, 7, v[3], v[4], v[ 9], v[14]);
+            }
+            #undef CV_B2B_G
+            for (int i = 0; i < 8; i++) h[i] ^= v[i] ^ v[i + 8];
+        }
+        void addCounter(uint64 n) { t[0] += n; if (t[0] < n) t[1]++; }
+    public:
+        explicit Blake2b(size_t digestLen) : bufLen(0), outLen(digestLen) {
+            for (int i = 0; i < 8; i++) h[i] = iv()[i];
+            h[0] ^= 0x01010000ULL ^ (uint64)outLen;   // depth 1, fanout 1, no key
+            t[0] = t[1] = 0;
+        }
+        ~Blake2b() { wipe(h, sizeof(h)); wipe(buf, sizeof(buf)); }
+        void update(const void* data, size_t len) {
+            const unsigned char* p = (const unsigned char*)data;
+            // The final block must be compressed with the last flag, so a full
+            // buffer is only flushed once more input arrives
+            while (len > 0) {
+                if (bufLen == 128) { addCounter(128); compress(buf, false); bufLen = 0; }
+                size_t n = len < 128 - bufLen ? len : 128 - bufLen;
+                memcpy(buf + bufLen, p, n);
+                bufLen += n; p += n; len -= n;
+            }
+        }
+        void updateLE32(uint32 v) { unsigned char b[4]; store32le(b, v); update(b, 4); }
+        void final(unsigned char* out) {
+            addCounter(bufLen);
+            memset(buf + bufLen, 0, 128 - bufLen);
+            compress(buf, true);
+            unsigned char full[64];
+            for (int i = 0; i < 8; i++) store64le(full + i * 8, h[i]);
+            memcpy(out, full, outLen);
+            wipe(full, sizeof(full));
+        }
+    };
+
+    // H' (RFC 9106 §3.3): variable-length hash built from chained 64-byte digests
+    inline void blake2bLong(unsigned char* out, uint32 outLen, const unsigned char* in, size_t inLen) {
+        if (outLen <= 64) {
+            Blake2b b(outLen);
+            b.updateLE32(outLen);
+            b.update(in, inLen);
+            b.final(out);
+            return;
+        }
+        unsigned char v[64];
+        Blake2b first(64);
+        first.updateLE32(outLen);
+        first.update(in, inLen);
+        first.final(v);
+        memcpy(out, v, 32);
+        uint32 pos = 32, remaining = outLen - 32;
+        while (remaining > 64) {
+            Blake2b b(64);
+            b.update(v, 64);
+            b.final(v);
+            memcpy(out + pos, v, 32);
+            pos += 32; remaining -= 32;
+        }
+        Blake2b last(remaining);
+        last.update(v, 64);
+        last.final(out + pos);
+        wipe(v, sizeof(v));
+    }
+
+    // ─── Argon2 memory blocks and compression G ───
+    static const size_t BLOCK_WORDS = 128;   // 1 KiB
+    static const uint32 SYNC_POINTS = 4;
+    struct Block { uint64 v[BLOCK_WORDS]; };
+
+    inline uint64 fBlaMka(uint64 x, uint64 y) {
+        return x + y + 2 * (uint64)(uint32)x * (uint32)y;
+    }
+    #define CV_ARGON_G(a, b, c, d) \
+        a = fBlaMka(a, b); d = rotr64(d ^ a, 32); c = fBlaMka(c, d); b = rotr64(b ^ c, 24); \
+        a = fBlaMka(a, b); d = rotr64(d ^ a, 16); c = fBlaMka(c, d); b = rotr64(b ^ c, 63)
+    #define CV_ARGON_ROUND(v0, v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15) \
+        CV_ARGON_G(v0, v4, v8, v12); CV_ARGON_G(v1, v5, v9, v13); \
+        CV_ARGON_G(v2, v6, v10, v14); CV_ARGON_G(v3, v7, v11, v15); \
+        CV_ARGON_G(v0, v5, v10, v15); CV_ARGON_G(v1, v6, v11, v12); \
+        CV_ARGON_G(v2, v7, v8, v13); CV_ARGON_G(v3, v4, v9, v14)
+
+    // next = G(prev, ref), XORed into next's old contents on passes after the first
+    inline void fillBlock(const Block& prev, const Block& ref, Block& next, bool withXor) {
+        Block r, tmp;
+        for (size_t i = 0; i < BLOCK_WORDS; i++) r.v[i] = prev.v[i] ^ ref.v[i];
+        tmp = r;
+        if (withXor) for (size_t i = 0; i < BLOCK_WORDS; i++) tmp.v[i] ^= next.v[i];
+        uint64* v = r.v;
+        for (int i = 0; i < 8; i++) {   // rows: 16 consecutive words
+            uint64* q = v + 16 * i;
+            CV_ARGON_ROUND(q[0], q[1], q[2], q[3], q[4], q[5], q[6], q[7],
+                           q[8], q[9], q[10], q[11], q[12], q[13], q[14], q[15]);
+        }
+        for (int i = 0; i < 8; i++) {   // columns: word pairs strided by 16
+            uint64* q = v + 2 * i;
+            CV_ARGON_ROUND(q[0], q[1], q[16], q[17], q[32], q[33], q[48], q[49],
+                           q[64], q[65], q[80], q[81], q[96], q[97], q[112], q[113]);
+        }
+        for (size_t i = 0; i < BLOCK_WORDS; i++) next.v[i] = tmp.v[i] ^ r.v[i];
+    }
+    #undef CV_ARGON_ROUND
+    #undef CV_ARGON_G
+
+    struct Instance {
+        std::vector<Block> memory;
+        uint32 passes, lanes, laneLength, segmentLength;
+    };
+
+    // Reference block for position `index` of a segment (RFC 9106 §3.4.1.2)
+    inline uint32 indexAlpha(const Instance& in, uint32 pass, uint32 slice, uint32 index,
+                             uint32 pseudoRand, bool sameLane) {
+        uint32 area;
+        if (pass == 0) {
+            if (slice == 0) area = index - 1;
+            else if (sameLane) area = slice * in.segmentLength + index - 1;
+            else area = slice * in.segmentLength - (index == 0 ? 1 : 0);
+        } else {
+            if (sameLane) area = in.laneLength - in.segmentLength + index - 1;
+            else area = in.laneLength - in.segmentLength - (index == 0 ? 1 : 0);
+        }
+        uint64 rel = pseudoRand;
+        rel = (rel * rel) >> 32;
+        rel = area - 1 - (((uint64)area * rel) >> 32);
+        uint32 start = (pass != 0 && slice != SYNC_POINTS - 1) ? (slice + 1) * in.segmentLength : 0;
+        return (uint32)((start + rel) % in.laneLength);
+    }
+
+    // Argon2id: data-independent addressing for the first half of pass 0,
+    // data-dependent everywhere else
+    inline void fillSegment(Instance& in, uint32 pass, uint32 lane, uint32 slice) {
+        bool independent = pass == 0 && slice < SYNC_POINTS / 2;
+        Block zero, input, address;
+        if (independent) {
+            memset(&zero, 0, sizeof(zero));
+            memset(&input, 0, sizeof(input));
+            input.v[0] = pass; input.v[1] = lane; input.v[2] = slice;
+            input.v[3] = in.memory.size(); input.v[4] = in.passes; input.v[5] = 2;   // type id
+        }
+        auto nextAddresses = [&] {
+            input.v[6]++;
+            fillBlock(zero, input, address, false);
+            fillBlock(zero, address, address, false);
+        };
+        uint32 startIndex = 0;
+        if (pass == 0 && slice == 0) {
+            startIndex = 2;   // blocks 0 and 1 come from H0
+            if (independent) nextAddresses();
+        }
+        uint32 curr = lane * in.laneLength + slice * in.segmentLength + startIndex;
+        uint32 prev = (curr % in.laneLength == 0) ? curr + in.laneLength - 1 : curr - 1;
+        for (uint32 i = startIndex; i < in.segmentLength; i++, curr++, prev++) {
+            if (curr % in.laneLength == 1) prev = curr - 1;
+            uint64 pseudoRand;
+            if (independent) {
+                if (i % BLOCK_WORDS == 0) nextAddresses();
+                pseudoRand = address.v[i % BLOCK_WORDS];
+            } else {
+                pseudoRand = in.memory[prev].v[0];
+            }
+            uint32 refLane = (pass == 0 && slice == 0) ? lane : (uint32)((pseudoRand >> 32) % in.lanes);
+            uint32 refIndex = indexAlpha(in, pass, slice, i, (uint32)pseudoRand, refLane == lane);
+            fillBlock(in.memory[prev], in.memory[(size_t)in.laneLength * refLane + refIndex],
+                      in.memory[curr], pass != 0);
+        }
+        if (independent) { wipe(&input, sizeof(input)); wipe(&address, sizeof(address)); }
+    }
+
+    // Minimum memory is 8 KiB per lane
+    inline uint32 minMemoryKiB(uint32 lanes) { return 8 * lanes; }
+
+    // Tag of outLen bytes; secret and associated data are optional (RFC 9106 K and X)
+    inline bool argon2id(const unsigned char* pwd, size_t pwdLen, const unsigned char* salt, size_t saltLen,
+                         uint32 passes, uint32 memoryKiB, uint32 lanes, unsigned char* out, uint32 outLen,
+                         const unsigned char* secret = nullptr, size_t secretLen = 0,
+                         const unsigned char* ad = nullptr, size_t adLen = 0) {
+        if (passes < 1 || lanes < 1 || lanes > 0xFFFFFF || outLen < 4 || memoryKiB < minMemoryKiB(lanes))
+            return false;
+        unsigned char h0[72];   // H0 plus the 8 bytes of block index appended below
+        {
+            Blake2b b(64);
+            b.updateLE32(lanes); b.updateLE32(outLen); b.updateLE32(memoryKiB);
+            b.updateLE32(passes); b.updateLE32(0x13); b.updateLE32(2);   // version, Argon2id
+            b.updateLE32((uint32)pwdLen); b.update(pwd, pwdLen);
+            b.updateLE32((uint32)saltLen); b.update(salt, saltLen);
+            b.updateLE32((uint32)secretLen); b.update(secret, secretLen);
+            b.updateLE32((uint32)adLen); b.update(ad, adLen);
+            b.final(h0);
+        }
+        Instance in;
+        in.passes = passes;
+        in.lanes = lanes;
+        in.segmentLength = memoryKiB / (lanes * SYNC_POINTS);
+        in.laneLength = in.segmentLength * SYNC_POINTS;
+        in.memory.resize((size_t)in.laneLength * lanes);
+
+        unsigned char blockBytes[1024];
+        for (uint32 l = 0; l < lanes; l++) {
+            for (uint32 j = 0; j < 2; j++) {
+                store32le(h0 + 64, j);
+                store32le(h0 + 68, l);
+                blake2bLong(blockBytes, 1024, h0, 72);
+                Block& b = in.memory[(size_t)l * in.laneLength + j];
+                for (size_t w = 0; w < BLOCK_WORDS; w++) b.v[w] = load64le(blockBytes + w * 8);
+            }
+        }
+        wipe(h0, sizeof(h0));
+
+        for (uint32 pass = 0; pass < passes; pass++) {
+            for (uint32 slice = 0; slice < SYNC_POINTS; slice++) {
+                // Segments of one slice never reference each other, so lanes run in parallel
+                unsigned cores = std::thread::hardware_concurrency();
+                if (lanes == 1 || cores <= 1) {
+                    for (uint32 l = 0; l < lanes; l++) fillSegment(in, pass, l, slice);
+                } else {
+                    std::vector<std::thread> pool;
+                    for (uint32 l = 0; l < lanes; l++)
+                        pool.emplace_back([&in, pass, l, slice] { fillSegment(in, pass, l, slice); });
+                    for (auto& t : pool) t.join();
+                }
+            }
+        }
+
+        Block acc = in.memory[in.laneLength - 1];
+        for (uint32 l = 1; l < lanes; l++) {
+            const Block& last = in.memory[(size_t)l * in.laneLength + in.laneLength - 1];
+            for (size_t w = 0; w < BLOCK_WORDS; w++) acc.v[w] ^= last.v[w];
+        }
+        for (size_t w = 0; w < BLOCK_WORDS; w++) store64le(blockBytes + w * 8, acc.v[w]);
+        blake2bLong(out, outLen, blockBytes, 1024);
+        wipe(blockBytes, sizeof(blockBytes));
+        wipe(&acc, sizeof(acc));
+        wipe(in.memory.data(), in.memory.size() * sizeof(Block));
+        return true;
+    }
+}
@@ -0,0 +1,417 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════
+// Async File Pipeline
+// Streams a file through a ring of slot buffers in jobs: while
+// job N is transformed on the calling thread, the reads for the
+// next jobs and the writes of the previous ones are in flight.
+// Two engines behind one call: io_uring on Linux (raw syscalls,
+// slots registered as fixed buffers) and a portable reader /
+// writer thread pair around the transform. The io_uring engine
+// is used when the kernel allows it; CRYPTVAULT_IO=threads or
+// setIoEngine() forces the thread engine.
+// Included by crypto_utils.h after secure_memzero.
+// ═══════════════════════════════════════════════════════════
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/uio.h>
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(IORING_FEAT_RW_CUR_POS)   // READ/WRITE ops: 5.6+
+#define CRYPTVAULT_HAVE_URING 1
+#endif
+#endif
+#endif
+
+namespace AsyncIO {
+    // One transfer between a file range and a slot: [bufOffset, bufOffset + len)
+    struct Span { unsigned long long fileOffset; size_t bufOffset; size_t len; };
+    // planReads runs ahead (on the reader side); transform runs in job order on
+    // the calling thread and lists the writes for its slot, false aborts the run
+    using PlanFn = function<void(size_t job, vector<Span>& reads)>;
+    using TransformFn = function<bool(size_t job, unsigned char* slot, vector<Span>& writes)>;
+    enum class Engine { Auto, Uring, Threads };
+    static const size_t DEPTH = 3;   // reading ahead, transforming, writing behind
+
+    // ─── Positional file I/O ───
+    inline int openRead(const string& path) {
+#ifdef _WIN32
+        return _open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+        return ::open(path.c_str(), O_RDONLY);
+#endif
+    }
+    inline int openWrite(const string& path) {
+#ifdef _WIN32
+        return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        return ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+#endif
+    }
+    inline void closeFd(int& fd) {
+#ifdef _WIN32
+        if (fd >= 0) _close(fd);
+#else
+        if (fd >= 0) ::close(fd);
+#endif
+        fd = -1;
+    }
+    inline bool transferAt(bool write, int fd, unsigned char* buf, size_t len, unsigned long long offset) {
+        while (len > 0) {
+#ifdef _WIN32
+            OVERLAPPED ov = {};
+            ov.Offset = (DWORD)offset;
+            ov.OffsetHigh = (DWORD)(offset >> 32);
+            DWORD want = (DWORD)min(len, (size_t)1 << 30), n = 0;
+            HANDLE h = (HANDLE)_get_osfhandle(fd);
+            BOOL ok = write ? WriteFile(h, buf, want, &n, &ov) : ReadFile(h, buf, want, &n, &ov);
+            if (!ok || n == 0) return false;
+#else
+            ssize_t n = write ? pwrite(fd, buf, len, (off_t)offset) : pread(fd, buf, len, (off_t)offset);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+#endif
+            buf += n; len -= (size_t)n; offset += (unsigned long long)n;
+        }
+        return true;
+    }
+    inline bool readAt(int fd, unsigned char* buf, size_t len, unsigned long long offset) {
+        return transferAt(false, fd, buf, len, offset);
+    }
+    inline bool writeAt(int fd, const unsigned char* buf, size_t len, unsigned long long offset) {
+        return transferAt(true, fd, (unsigned char*)buf, len, offset);
+    }
+
+    // ─── Thread engine ───
+    // Reader and writer threads hand slots to the transform and back;
+    // each slot cycles Free -> Loaded -> Ready -> Free
+    inline bool runThreads(int inFd, int outFd, size_t jobs, unsigned char* pool, size_t slotSize,
+                           const PlanFn& planReads, const TransformFn& transform) {
+        enum State { Free, Loaded, Ready };
+        State state[DEPTH] = {Free, Free, Free};
+        vector<Span> writes[DEPTH];
+        mutex m;
+        condition_variable cv;
+        bool abort = false;
+        const char* ioError = nullptr;
+        auto fail = [&](const char* msg) {
+            lock_guard<mutex> g(m);
+            if (!ioError) ioError = msg;
+            abort = true;
+            cv.notify_all();
+        };
+        auto await = [&](size_t slot, State want) {
+            unique_lock<mutex> g(m);
+            cv.wait(g, [&] { return abort || state[slot] == want; });
+            return !abort;
+        };
+        auto advance = [&](size_t slot, State next) {
+            lock_guard<mutex> g(m);
+            state[slot] = next;
+            cv.notify_all();
+        };
+        thread reader([&] {
+            vector<Span> reads;
+            for (size_t j = 0; j < jobs; j++) {
+                size_t slot = j % DEPTH;
+                if (!await(slot, Free)) return;
+                reads.clear();
+                planReads(j, reads);
+                for (auto& r : reads)
+                    if (!readAt(inFd, pool + slot * slotSize + r.bufOffset, r.len, r.fileOffset)) return fail("Read failed");
+                advance(slot, Loaded);
+            }
+        });
+        thread writer([&] {
+            for (size_t j = 0; j < jobs; j++) {
+                size_t slot = j % DEPTH;
+                if (!await(slot, Ready)) return;
+                for (auto& w : writes[slot])
+                    if (!writeAt(outFd, pool + slot * slotSize + w.bufOffset, w.len, w.fileOffset)) return fail("Write failed");
+                advance(slot, Free);
+            }
+        });
+        bool ok = true;
+        for (size_t j = 0; ok && j < jobs; j++) {
+            size_t slot = j % DEPTH;
+            ok = await(slot, Loaded);
+            if (!ok) break;
+            writes[slot].clear();
+            ok = transform(j, pool + slot * slotSize, writes[slot]);
+            if (ok) advance(slot, Ready);
+            else { lock_guard<mutex> g(m); abort = true; cv.notify_all(); }
+        }
+        reader.join();
+        writer.join();
+        if (ioError) cerr << "\n❌ Error: " << ioError << endl;
+        return ok && !ioError;
+    }
+
+#ifdef CRYPTVAULT_HAVE_URING
+    // ─── io_uring engine ───
+    // Minimal ring over the raw syscalls: one submission queue, one
+    // completion queue, the slots registered as fixed buffers
+    class Ring {
+        int fd = -1;
+        unsigned char *sqMap = nullptr, *cqMap = nullptr;
+        size_t sqMapLen = 0, cqMapLen = 0, sqesLen = 0;
+        io_uring_sqe* sqes = nullptr;
+        io_uring_cqe* cqes = nullptr;
+        unsigned *sqHead = nullptr, *sqTail = nullptr, *sqMask = nullptr, *sqArray = nullptr;
+        unsigned *cqHead = nullptr, *cqTail = nullptr, *cqMask = nullptr;
+        unsigned sqEntries = 0, unsubmitted = 0;
+        bool fixed = false;
+    public:
+        unsigned cqEntries = 0;
+        Ring() = default;
+        Ring(const Ring&) = delete;
+        Ring& operator=(const Ring&) = delete;
+        ~Ring() { close(); }
+
+        bool setup(unsigned entries) {
+            io_uring_params p;
+            memset(&p, 0, sizeof(p));
+            fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+            if (fd < 0) return false;
+            sqEntries = p.sq_entries;
+            cqEntries = p.cq_entries;
+            sqMapLen = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+            cqMapLen = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+            bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single) sqMapLen = cqMapLen = max(sqMapLen, cqMapLen);
+            void* sq = mmap(nullptr, sqMapLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            if (sq == MAP_FAILED) { close(); return false; }
+            sqMap = (unsigned char*)sq;
+            if (single) cqMap = sqMap;
+            else {
+                void* cq = mmap(nullptr, cqMapLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+                if (cq == MAP_FAILED) { close(); return false; }
+                cqMap = (unsigned char*)cq;
+            }
+            sqesLen = p.sq_entries * sizeof(io_uring_sqe);
+            void* s = mmap(nullptr, sqesLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+            if (s == MAP_FAILED) { sqes = nullptr; close(); return false; }
+            sqes = (io_uring_sqe*)s;
+            sqHead = (unsigned*)(sqMap + p.sq_off.head);
+            sqTail = (unsigned*)(sqMap + p.sq_off.tail);
+            sqMask = (unsigned*)(sqMap + p.sq_off.ring_mask);
+            sqArray = (unsigned*)(sqMap + p.sq_off.array);
+            cqHead = (unsigned*)(cqMap + p.cq_off.head);
+            cqTail = (unsigned*)(cqMap + p.cq_off.tail);
+            cqMask = (unsigned*)(cqMap + p.cq_off.ring_mask);
+            cqes = (io_uring_cqe*)(cqMap + p.cq_off.cqes);
+            return true;
+        }
+        // Slot i becomes fixed buffer i; without it plain READ/WRITE ops are used
+        void registerBuffers(unsigned char* pool, size_t slotSize, size_t slots) {
+            vector<iovec> iov(slots);
+            for (size_t i = 0; i < slots; i++) { iov[i].iov_base = pool + i * slotSize; iov[i].iov_len = slotSize; }
+            fixed = syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, iov.data(), (unsigned)slots) == 0;
+        }
+        // Queue one transfer; false when the submission queue is full
+        bool push(bool write, int fileFd, unsigned char* buf, unsigned len, unsigned long long offset,
+                  unsigned bufIndex, unsigned long long userData) {
+            unsigned tail = *sqTail;
+            if (tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) return false;
+            unsigned idx = tail & *sqMask;
+            io_uring_sqe& e = sqes[idx];
+            memset(&e, 0, sizeof(e));
+            if (fixed) e.opcode = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+            else e.opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+            e.fd = fileFd;
+            e.addr = (unsigned long long)(uintptr_t)buf;
+            e.len = len;
+            e.off = offset;
+            if (fixed) e.buf_index = (unsigned short)bufIndex;
+            e.user_data = userData;
+            sqArray[idx] = idx;
+            __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+            unsubmitted++;
+            return true;
+        }
+        // Submit everything queued and wait for at least `wait` completions
+        bool enter(unsigned wait) {
+            while (unsubmitted > 0 || wait > 0) {
+                long r = syscall(__NR_io_uring_enter, fd, unsubmitted, wait, wait ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+                if (r < 0) {
+                    if (errno == EINTR || errno == EAGAIN) continue;
+                    return false;
+                }
+                unsubmitted -= min(unsubmitted, (unsigned)r);
+                wait = 0;
+            }
+            return true;
+        }
+        template <class F> void reap(F&& onComplete) {
+            unsigned head = *cqHead, tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            for (; head != tail; head++) {
+                const io_uring_cqe& c = cqes[head & *cqMask];
+                onComplete(c.user_data, c.res);
+            }
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+        }
+        void close() {
+            if (sqes) munmap(sqes, sqesLen);
+            if (cqMap && cqMap != sqMap) munmap(cqMap, cqMapLen);
+            if (sqMap) munmap(sqMap, sqMapLen);
+            if (fd >= 0) ::close(fd);
+            sqes = nullptr; sqMap = cqMap = nullptr; fd = -1;
+        }
+    };
+
+    // Single-threaded event loop: reads are queued up to DEPTH - 1 jobs
+    // ahead, each transform starts once its reads land, and its writes are
+    // queued behind it. Short transfers are resubmitted for the remainder.
+    // `ran` is false when no ring could be set up (nothing was touched).
+    inline bool runUring(int inFd, int outFd, size_t jobs, unsigned char* pool, size_t slotSize,
+                         const PlanFn& planReads, const TransformFn& transform, bool& ran) {
+        Ring ring;
+        ran = ring.setup(64);
+        if (!ran) return false;
+        ring.registerBuffers(pool, slotSize, DEPTH);
+
+        struct Op { size_t slot; bool write; unsigned long long offset; unsigned char* buf; size_t left; };
+        vector<Op> ops;
+        vector<size_t> freeOps;
+        deque<size_t> queued;
+        unsigned inflight = 0;
+        size_t readsLeft[DEPTH] = {0}, writesLeft[DEPTH] = {0};
+        bool busy[DEPTH] = {false};
+        vector<Span> spans;
+        size_t nextRead = 0, nextTransform = 0, written = 0;
+        const char* ioError = nullptr;
+        int ioErrno = 0;
+
+        auto enqueue = [&](size_t slot, bool write, const Span& s) {
+            size_t id;
+            if (freeOps.empty()) { id = ops.size(); ops.push_back({}); }
+            else { id = freeOps.back(); freeOps.pop_back(); }
+            ops[id] = {slot, write, s.fileOffset, pool + slot * slotSize + s.bufOffset, s.len};
+            queued.push_back(id);
+        };
+        // Move queued ops into the ring, never more in flight than the CQ holds
+        auto pump = [&] {
+            while (!queued.empty() && inflight < ring.cqEntries) {
+                Op& op = ops[queued.front()];
+                unsigned len = (unsigned)min(op.left, (size_t)1 << 30);
+                if (!ring.push(op.write, op.write ? outFd : inFd, op.buf, len, op.offset,
+                               (unsigned)op.slot, queued.front())) {
+                    if (!ring.enter(0)) return false;
+                    continue;
+                }
+                queued.pop_front();
+                inflight++;
+            }
+            return ring.enter(0);
+        };
+        auto complete = [&](unsigned long long id, int res) {
+            inflight--;
+            Op& op = ops[(size_t)id];
+            if (res == -EINTR || res == -EAGAIN) { queued.push_back((size_t)id); return; }
+            if (res <= 0) {
+                if (!ioError) { ioError = op.write ? "Write failed" : "Read failed"; ioErrno = res < 0 ? -res : 0; }
+                freeOps.push_back((size_t)id);
+                return;
+            }
+            op.offset += (unsigned long long)res; op.buf += res; op.left -= (size_t)res;
+            if (op.left > 0) { queued.push_back((size_t)id); return; }
+            freeOps.push_back((size_t)id);
+            if (!op.write) { readsLeft[op.slot]--; return; }
+            if (--writesLeft[op.slot] == 0) { busy[op.slot] = false; written++; }
+        };
+
+        bool ok = true;
+        while (ok && !ioError && written < jobs) {
+            while (nextRead < jobs && nextRead < nextTransform + DEPTH && !busy[nextRead % DEPTH]) {
+                size_t slot = nextRead % DEPTH;
+                spans.clear();
+                planReads(nextRead, spans);
+                busy[slot] = true;
+                readsLeft[slot] = 0;
+                for (auto& s : spans) if (s.len) { enqueue(slot, false, s); readsLeft[slot]++; }
+                nextRead++;
+            }
+            if (!pump()) { ioError = "io_uring submission failed"; ioErrno = errno; break; }
+            size_t slot = nextTransform % DEPTH;
+            if (nextTransform < nextRead && readsLeft[slot] == 0) {
+                spans.clear();
+                ok = transform(nextTransform, pool + slot * slotSize, spans);
+                if (!ok) break;
+                writesLeft[slot] = 0;
+                for (auto& s : spans) if (s.len) { enqueue(slot, true, s); writesLeft[slot]++; }
+                if (writesLeft[slot] == 0) { busy[slot] = false; written++; }
+                nextTransform++;
+                continue;
+            }
+            if (inflight == 0) { ioError = "I/O pipeline stalled"; break; }
+            if (!ring.enter(1)) { ioError = "io_uring wait failed"; ioErrno = errno; break; }
+            ring.reap(complete);
+        }
+        // The kernel may still be using the slots; let every transfer finish
+        while (inflight > 0 && ring.enter(1)) ring.reap([&](unsigned long long, int) { inflight--; });
+        if (ioError) {
+            cerr << "\n❌ Error: " << ioError;
+            if (ioErrno) cerr << " (" << strerror(ioErrno) << ")";
+            cerr << endl;
+        }
+        return ok && !ioError;
+    }
+#endif
+
+    // Engine a run with `requested` would use on this host
+    inline Engine resolve(Engine requested) {
+        if (requested == Engine::Auto) {
+            const char* env = getenv("CRYPTVAULT_IO");
+            if (env && string(env) == "threads") return Engine::Threads;
+        }
+        if (requested == Engine::Threads) return Engine::Threads;
+#ifdef CRYPTVAULT_HAVE_URING
+        static const bool usable = [] { Ring r; return r.setup(2); }();
+        if (usable) return Engine::Uring;
+#endif
+        return Engine::Threads;
+    }
+    inline const char* engineName(Engine e) { return e == Engine::Uring ? "io_uring" : "threads"; }
+
+    // Run `jobs` jobs of at most `slotSize` bytes each from inFd to outFd
+    inline bool run(int inFd, int outFd, size_t jobs, size_t slotSize,
+                    const PlanFn& planReads, const TransformFn& transform, Engine requested = Engine::Auto) {
+        if (jobs == 0) return true;
+        if (jobs == 1) {
+            // Nothing to overlap: skip the engine setup, which dominates for small files
+            vector<unsigned char> slot(slotSize);
+            vector<Span> spans;
+            planReads(0, spans);
+            bool ok = true;
+            for (auto& r : spans)
+                if (ok && !readAt(inFd, slot.data() + r.bufOffset, r.len, r.fileOffset)) {
+                    cerr << "\n❌ Error: Read failed" << endl;
+                    ok = false;
+                }
+            spans.clear();
+            ok = ok && transform(0, slot.data(), spans);
+            for (auto& w : spans)
+                if (ok && !writeAt(outFd, slot.data() + w.bufOffset, w.len, w.fileOffset)) {
+                    cerr << "\n❌ Error: Write failed" << endl;
+                    ok = false;
+                }
+            secure_memzero(slot.data(), slot.size());
+            return ok;
+        }
+        vector<unsigned char> pool(DEPTH * slotSize);
+        bool ok = false, ran = false;
+#ifdef CRYPTVAULT_HAVE_URING
+        if (resolve(requested) == Engine::Uring)
+            ok = runUring(inFd, outFd, jobs, pool.data(), slotSize, planReads, transform, ran);
+#else
+        (void)requested;
+#endif
+        if (!ran) ok = runThreads(inFd, outFd, jobs, pool.data(), slotSize, planReads, transform);
+        secure_memzero(pool.data(), pool.size());
+        return ok;
+    }
+}
@@ -0,0 +1,373 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════
+// ChaCha20-Poly1305 AEAD (RFC 8439)
+// ChaCha20 runs 4 (SSE2) or 8 (AVX2) blocks side by side, one per
+// vector lane; Poly1305 is the donna limb arithmetic.
+// Constant time on every host, no AES hardware required.
+// ═══════════════════════════════════════════════════════════
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstddef>
+#include "cpu_features.h"
+
+namespace ChaChaImpl {
+    typedef unsigned int uint32;
+    typedef unsigned long long uint64;
+
+    inline uint32 load32le(const unsigned char* p) {
+        return (uint32)p[0] | ((uint32)p[1] << 8) | ((uint32)p[2] << 16) | ((uint32)p[3] << 24);
+    }
+    inline void store32le(unsigned char* p, uint32 v) {
+        p[0] = (unsigned char)v; p[1] = (unsigned char)(v >> 8);
+        p[2] = (unsigned char)(v >> 16); p[3] = (unsigned char)(v >> 24);
+    }
+    inline void wipe(void* p, size_t len) {
+        volatile unsigned char* v = (volatile unsigned char*)p;
+        while (len--) *v++ = 0;
+    }
+
+    #define CV_ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+    #define CV_QUARTER(x, a, b, c, d) \
+        x[a] += x[b]; x[d] ^= x[a]; x[d] = CV_ROTL(x[d], 16); \
+        x[c] += x[d]; x[b] ^= x[c]; x[b] = CV_ROTL(x[b], 12); \
+        x[a] += x[b]; x[d] ^= x[a]; x[d] = CV_ROTL(x[d], 8);  \
+        x[c] += x[d]; x[b] ^= x[c]; x[b] = CV_ROTL(x[b], 7)
+    #define CV_DOUBLE_ROUND(x) \
+        CV_QUARTER(x, 0, 4,  8, 12); CV_QUARTER(x, 1, 5,  9, 13); \
+        CV_QUARTER(x, 2, 6, 10, 14); CV_QUARTER(x, 3, 7, 11, 15); \
+        CV_QUARTER(x, 0, 5, 10, 15); CV_QUARTER(x, 1, 6, 11, 12); \
+        CV_QUARTER(x, 2, 7,  8, 13); CV_QUARTER(x, 3, 4,  9, 14)
+
+    // state: constants, key, counter, nonce
+    inline void initState(uint32 st[16], const unsigned char key[32], uint32 counter, const unsigned char nonce[12]) {
+        st[0] = 0x61707865; st[1] = 0x3320646e; st[2] = 0x79622d32; st[3] = 0x6b206574;
+        for (int i = 0; i < 8; i++) st[4 + i] = load32le(key + i*4);
+        st[12] = counter;
+        for (int i = 0; i < 3; i++) st[13 + i] = load32le(nonce + i*4);
+    }
+
+    inline void blockScalar(const uint32 st[16], unsigned char out[64]) {
+        uint32 x[16];
+        memcpy(x, st, sizeof(x));
+        for (int i = 0; i < 10; i++) { CV_DOUBLE_ROUND(x); }
+        for (int i = 0; i < 16; i++) store32le(out + i*4, x[i] + st[i]);
+    }
+
+#if defined(CRYPTVAULT_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CRYPTVAULT_CHACHA_VECTOR 1
+    // Lane l computes the block with counter st[12] + l
+    typedef uint32 ChaVec4 __attribute__((vector_size(16)));
+    typedef uint32 ChaVec8 __attribute__((vector_size(32)));
+
+    template <class V, int L>
+    __attribute__((always_inline)) inline void blocksVertical(const uint32 st[16], unsigned char* out) {
+        V x[16], in[16];
+        for (int i = 0; i < 16; i++)
+            for (int l = 0; l < L; l++) in[i][l] = st[i];
+        for (int l = 0; l < L; l++) in[12][l] += (uint32)l;
+        for (int i = 0; i < 16; i++) x[i] = in[i];
+        for (int i = 0; i < 10; i++) { CV_DOUBLE_ROUND(x); }
+        for (int i = 0; i < 16; i++) x[i] += in[i];
+        // x86 is little-endian: lanes go straight out as keystream words
+        for (int l = 0; l < L; l++)
+            for (int i = 0; i < 16; i++) { uint32 w = x[i][l]; memcpy(out + l*64 + i*4, &w, 4); }
+    }
+    inline void blocks4(const uint32 st[16], unsigned char out[256]) {
+        blocksVertical<ChaVec4, 4>(st, out);
+    }
+    CV_TARGET("avx2")
+    inline void blocks8(const uint32 st[16], unsigned char out[512]) {
+        blocksVertical<ChaVec8, 8>(st, out);
+    }
+#endif
+    #undef CV_DOUBLE_ROUND
+    #undef CV_QUARTER
+    #undef CV_ROTL
+
+    enum class Backend { Scalar, Sse2, Avx2 };
+    inline Backend usable(Backend b) {
+#ifdef CRYPTVAULT_CHACHA_VECTOR
+        const auto& f = CpuFeatures::get();
+        if (b == Backend::Avx2 && f.avx2) return Backend::Avx2;
+        if (b != Backend::Scalar && f.sse2) return Backend::Sse2;
+#else
+        (void)b;
+#endif
+        return Backend::Scalar;
+    }
+    // Override with CRYPTVAULT_CHACHA_BACKEND=scalar|sse2|avx2
+    inline Backend bestBackend() {
+        static const Backend chosen = [] {
+            const char* env = getenv("CRYPTVAULT_CHACHA_BACKEND");
+            std::string want = env ? env : "";
+            if (want == "scalar") return Backend::Scalar;
+            if (want == "sse2") return usable(Backend::Sse2);
+            return usable(Backend::Avx2);
+        }();
+        return chosen;
+    }
+    inline const char* backendName(Backend b) {
+        switch (b) {
+            case Backend::Avx2: return "AVX2";
+            case Backend::Sse2: return "SSE2";
+            default:            return "Scalar";
+        }
+    }
+
+    // XOR the keystream starting at block `counter` into data
+    inline void xorStream(const unsigned char key[32], const unsigned char nonce[12], uint32 counter,
+                          unsigned char* data, size_t len) {
+        uint32 st[16];
+        initState(st, key, counter, nonce);
+        unsigned char ks[512];
+        Backend backend = bestBackend();
+        while (len > 0) {
+            size_t produced = 64;
+#ifdef CRYPTVAULT_CHACHA_VECTOR
+            if (backend == Backend::Avx2 && len > 256) { blocks8(st, ks); produced = 512; }
+            else if (backend != Backend::Scalar && len > 64) { blocks4(st, ks); produced = 256; }
+            else
+#endif
+                blockScalar(st, ks);
+            st[12] += (uint32)(produced / 64);
+            size_t n = len < produced ? len : produced;
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                uint64 d, k;
+                memcpy(&d, data + i, 8); memcpy(&k, ks + i, 8);
+                d ^= k;
+                memcpy(data + i, &d, 8);
+            }
+            for (; i < n; i++) data[i] ^= ks[i];
+            data += n; len -= n;
+        }
+        wipe(ks, sizeof(ks));
+        wipe(st, sizeof(st));
+    }
+
+    inline uint64 load64le(const unsigned char* p) {
+        return (uint64)load32le(p) | ((uint64)load32le(p + 4) << 32);
+    }
+
+    // One-time authenticator; message bytes are absorbed in 16-byte blocks.
+    // 64-bit hosts use three 44/44/42-bit limbs with 128-bit products
+    // (poly1305-donna-64); others five 26-bit limbs (poly1305-donna-32).
+    class Poly1305 {
+#ifdef __SIZEOF_INT128__
+        typedef unsigned __int128 uint128;
+        uint64 r[3], h[3], pad[2];
+#else
+        uint32 r[5], h[5], pad[4];
+#endif
+        unsigned char buffer[16];
+        size_t leftover;
+#ifdef __SIZEOF_INT128__
+        void blocks(const unsigned char* m, size_t bytes, uint64 hibit) {
+            const uint64 s1 = r[1] * (5 << 2), s2 = r[2] * (5 << 2);
+            uint64 h0 = h[0], h1 = h[1], h2 = h[2];
+            while (bytes >= 16) {
+                uint64 t0 = load64le(m), t1 = load64le(m + 8);
+                h0 += t0 & 0xfffffffffffULL;
+                h1 += ((t0 >> 44) | (t1 << 20)) & 0xfffffffffffULL;
+                h2 += ((t1 >> 24) & 0x3ffffffffffULL) | hibit;
+                uint128 d0 = (uint128)h0*r[0] + (uint128)h1*s2 + (uint128)h2*s1;
+                uint128 d1 = (uint128)h0*r[1] + (uint128)h1*r[0] + (uint128)h2*s2;
+                uint128 d2 = (uint128)h0*r[2] + (uint128)h1*r[1] + (uint128)h2*r[0];
+                uint64 c = (uint64)(d0 >> 44); h0 = (uint64)d0 & 0xfffffffffffULL;
+                d1 += c; c = (uint64)(d1 >> 44); h1 = (uint64)d1 & 0xfffffffffffULL;
+                d2 += c; c = (uint64)(d2 >> 42); h2 = (uint64)d2 & 0x3ffffffffffULL;
+                h0 += c * 5; c = h0 >> 44; h0 &= 0xfffffffffffULL;
+                h1 += c;
+                m += 16; bytes -= 16;
+            }
+            h[0] = h0; h[1] = h1; h[2] = h2;
+        }
+        static const uint64 HIBIT = 1ULL << 40;
+#else
+        void blocks(const unsigned char* m, size_t bytes, uint32 hibit) {
+            const uint32 s1 = r[1] * 5, s2 = r[2] * 5, s3 = r[3] * 5, s4 = r[4] * 5;
+            uint32 h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3], h4 = h[4];
+            while (bytes >= 16) {
+                h0 += (load32le(m))           & 0x3ffffff;
+                h1 += (load32le(m + 3) >> 2)  & 0x3ffffff;
+                h2 += (load32le(m + 6) >> 4)  & 0x3ffffff;
+                h3 += (load32le(m + 9) >> 6)  & 0x3ffffff;
+                h4 += (load32le(m + 12) >> 8) | hibit;
+                uint64 d0 = (uint64)h0*r[0] + (uint64)h1*s4 + (uint64)h2*s3 + (uint64)h3*s2 + (uint64)h4*s1;
+                uint64 d1 = (uint64)h0*r[1] + (uint64)h1*r[0] + (uint64)h2*s4 + (uint64)h3*s3 + (uint64)h4*s2;
+                uint64 d2 = (uint64)h0*r[2] + (uint64)h1*r[1] + (uint64)h2*r[0] + (uint64)h3*s4 + (uint64)h4*s3;
+                uint64 d3 = (uint64)h0*r[3] + (uint64)h1*r[2] + (uint64)h2*r[1] + (uint64)h3*r[0] + (uint64)h4*s4;
+                uint64 d4 = (uint64)h0*r[4] + (uint64)h1*r[3] + (uint64)h2*r[2] + (uint64)h3*r[1] + (uint64)h4*r[0];
+                uint32 c = (uint32)(d0 >> 26); h0 = (uint32)d0 & 0x3ffffff;
+                d1 += c; c = (uint32)(d1 >> 26); h1 = (uint32)d1 & 0x3ffffff;
+                d2 += c; c = (uint32)(d2 >> 26); h2 = (uint32)d2 & 0x3ffffff;
+                d3 += c; c = (uint32)(d3 >> 26); h3 = (uint32)d3 & 0x3ffffff;
+                d4 += c; c = (uint32)(d4 >> 26); h4 = (uint32)d4 & 0x3ffffff;
+                h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+                h1 += c;
+                m += 16; bytes -= 16;
+            }
+            h[0] = h0; h[1] = h1; h[2] = h2; h[3] = h3; h[4] = h4;
+        }
+        static const uint32 HIBIT = 1u << 24;
+#endif
+    public:
+        explicit Poly1305(const unsigned char key[32]) : leftover(0) {
+#ifdef __SIZEOF_INT128__
+            uint64 t0 = load64le(key), t1 = load64le(key + 8);
+            r[0] = t0 & 0xffc0fffffffULL;
+            r[1] = ((t0 >> 44) | (t1 << 20)) & 0xfffffc0ffffULL;
+            r[2] = (t1 >> 24) & 0x00ffffffc0fULL;
+            for (int i = 0; i < 2; i++) pad[i] = load64le(key + 16 + i*8);
+#else
+            r[0] = (load32le(key))           & 0x3ffffff;
+            r[1] = (load32le(key + 3) >> 2)  & 0x3ffff03;
+            r[2] = (load32le(key + 6) >> 4)  & 0x3ffc0ff;
+            r[3] = (load32le(key + 9) >> 6)  & 0x3f03fff;
+            r[4] = (load32le(key + 12) >> 8) & 0x00fffff;
+            for (int i = 0; i < 4; i++) pad[i] = load32le(key + 16 + i*4);
+#endif
+            memset(h, 0, sizeof(h));
+        }
+        ~Poly1305() { wipe(r, sizeof(r)); wipe(pad, sizeof(pad)); }
+        void update(const unsigned char* m, size_t bytes) {
+            if (leftover > 0) {
+                size_t take = bytes < 16 - leftover ? bytes : 16 - leftover;
+                memcpy(buffer + leftover, m, take);
+                leftover += take; m += take; bytes -= take;
+                if (leftover < 16) return;
+                blocks(buffer, 16, HIBIT);
+                leftover = 0;
+            }
+            size_t whole = bytes & ~(size_t)15;
+            if (whole > 0) blocks(m, whole, HIBIT);
+            m += whole; bytes -= whole;
+            memcpy(buffer, m, bytes);
+            leftover = bytes;
+        }
+        // Zero-fill to a block boundary (the AEAD padding is part of the message)
+        void pad16() {
+            if (leftover == 0) return;
+            memset(buffer + leftover, 0, 16 - leftover);
+            blocks(buffer, 16, HIBIT);
+            leftover = 0;
+        }
+        void finish(unsigned char mac[16]) {
+            if (leftover > 0) {
+                buffer[leftover] = 1;
+                for (size_t i = leftover + 1; i < 16; i++) buffer[i] = 0;
+                blocks(buffer, 16, 0);
+            }
+#ifdef __SIZEOF_INT128__
+            uint64 h0 = h[0], h1 = h[1], h2 = h[2], c;
+            for (int pass = 0; pass < 2; pass++) {
+                c = h1 >> 44; h1 &= 0xfffffffffffULL;
+                h2 += c; c = h2 >> 42; h2 &= 0x3ffffffffffULL;
+                h0 += c * 5; c = h0 >> 44; h0 &= 0xfffffffffffULL;
+                h1 += c;
+            }
+            // g = h + 5 - 2^130; keep h if g is negative
+            uint64 g0 = h0 + 5; c = g0 >> 44; g0 &= 0xfffffffffffULL;
+            uint64 g1 = h1 + c; c = g1 >> 44; g1 &= 0xfffffffffffULL;
+            uint64 g2 = h2 + c - (1ULL << 42);
+            uint64 mask = (g2 >> 63) - 1;
+            h0 = (h0 & ~mask) | (g0 & mask);
+            h1 = (h1 & ~mask) | (g1 & mask);
+            h2 = (h2 & ~mask) | (g2 & mask);
+            // h mod 2^128 + s
+            h0 += pad[0] & 0xfffffffffffULL; c = h0 >> 44; h0 &= 0xfffffffffffULL;
+            h1 += (((pad[0] >> 44) | (pad[1] << 20)) & 0xfffffffffffULL) + c; c = h1 >> 44; h1 &= 0xfffffffffffULL;
+            h2 += ((pad[1] >> 24) & 0x3ffffffffffULL) + c; h2 &= 0x3ffffffffffULL;
+            uint64 lo = h0 | (h1 << 44), hi = (h1 >> 20) | (h2 << 24);
+            store32le(mac, (uint32)lo); store32le(mac + 4, (uint32)(lo >> 32));
+            store32le(mac + 8, (uint32)hi); store32le(mac + 12, (uint32)(hi >> 32));
+#else
+            uint32 h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3], h4 = h[4], c;
+            c = h1 >> 26; h1 &= 0x3ffffff; h2 += c;
+            c = h2 >> 26; h2 &= 0x3ffffff; h3 += c;
+            c = h3 >> 26; h3 &= 0x3ffffff; h4 += c;
+            c = h4 >> 26; h4 &= 0x3ffffff; h0 += c * 5;
+            c = h0 >> 26; h0 &= 0x3ffffff; h1 += c;
+            // g = h + 5 - 2^130; keep h if g is negative
+            uint32 g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3ffffff;
+            uint32 g1 = h1 + c; c = g1 >> 26; g1 &= 0x3ffffff;
+            uint32 g2 = h2 + c; c = g2 >> 26; g2 &= 0x3ffffff;
+            uint32 g3 = h3 + c; c = g3 >> 26; g3 &= 0x3ffffff;
+            uint32 g4 = h4 + c - (1u << 26);
+            uint32 mask = (g4 >> 31) - 1;
+            h0 = (h0 & ~mask) | (g0 & mask); h1 = (h1 & ~mask) | (g1 & mask);
+            h2 = (h2 & ~mask) | (g2 & mask); h3 = (h3 & ~mask) | (g3 & mask);
+            h4 = (h4 & ~mask) | (g4 & mask);
+            // h mod 2^128 + s
+            h0 = h0 | (h1 << 26);
+            h1 = (h1 >> 6) | (h2 << 20);
+            h2 = (h2 >> 12) | (h3 << 14);
+            h3 = (h3 >> 18) | (h4 << 8);
+            uint64 f = (uint64)h0 + pad[0];             store32le(mac, (uint32)f);
+            f = (uint64)h1 + pad[1] + (f >> 32);        store32le(mac + 4, (uint32)f);
+            f = (uint64)h2 + pad[2] + (f >> 32);        store32le(mac + 8, (uint32)f);
+            f = (uint64)h3 + pad[3] + (f >> 32);        store32le(mac + 12, (uint32)f);
+#endif
+            wipe(h, sizeof(h));
+        }
+    };
+}
+
+class ChaCha20Poly1305 {
+    unsigned char key[32];
+public:
+    static const int NONCE_SIZE = 12;
+    static const int TAG_SIZE = 16;
+    ChaCha20Poly1305() { memset(key, 0, 32); }
+    ~ChaCha20Poly1305() { ChaChaImpl::wipe(key, 32); }
+    void setKey(const unsigned char k[32]) { memcpy(key, k, 32); }
+    // Poly1305 one-time key = first 32 bytes of keystream block 0
+    void polyKey(const unsigned char nonce[12], unsigned char out[32]) const {
+        memset(out, 0, 32);
+        ChaChaImpl::xorStream(key, nonce, 0, out, 32);
+    }
+    // Payload keystream starts at block 1
+    void crypt(const unsigned char nonce[12], unsigned char* data, size_t len) const {
+        ChaChaImpl::xorStream(key, nonce, 1, data, len);
+    }
+    // mac_data = A || pad16 || C || pad16 || le64(len A) || le64(len C)
+    static void finishTag(ChaChaImpl::Poly1305& mac, unsigned long long aadLen, unsigned long long ctLen,
+                          unsigned char tag[16]) {
+        unsigned char lens[16];
+        mac.pad16();
+        for (int i = 0; i < 8; i++) {
+            lens[i] = (unsigned char)(aadLen >> (8*i));
+            lens[8 + i] = (unsigned char)(ctLen >> (8*i));
+        }
+        mac.update(lens, 16);
+        mac.finish(tag);
+    }
+    void seal(const unsigned char nonce[12], const unsigned char* aad, size_t aadLen,
+              unsigned char* data, size_t len, unsigned char tag[16]) const {
+        unsigned char pk[32];
+        polyKey(nonce, pk);
+        ChaChaImpl::Poly1305 mac(pk);
+        ChaChaImpl::wipe(pk, 32);
+        crypt(nonce, data, len);
+        mac.update(aad, aadLen); mac.pad16();
+        mac.update(data, len);
+        finishTag(mac, aadLen, len, tag);
+    }
+    // Verifies before decrypting; data is left untouched on failure
+    bool open(const unsigned char nonce[12], const unsigned char* aad, size_t aadLen,
+              unsigned char* data, size_t len, const unsigned char tag[16]) const {
+        unsigned char pk[32], expected[16];
+        polyKey(nonce, pk);
+        ChaChaImpl::Poly1305 mac(pk);
+        ChaChaImpl::wipe(pk, 32);
+        mac.update(aad, aadLen); mac.pad16();
+        mac.update(data, len);
+        finishTag(mac, aadLen, len, expected);
+        unsigned char diff = 0;
+        for (int i = 0; i < 16; i++) diff |= expected[i] ^ tag[i];
+        if (diff != 0) return false;
+        crypt(nonce, data, len);
+        return true;
+    }
+};
@@ -0,0 +1,91 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════
+// CPU Feature Detection (CPUID)
+// Runtime counterpart of check_aes_support in asm/crypto_asm.asm.
+// Kernels built with CV_TARGET(...) must only be called after
+// the matching flag has been checked here.
+// ═══════════════════════════════════════════════════════════
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CRYPTVAULT_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CV_TARGET(features) __attribute__((target(features)))
+#else
+#define CV_TARGET(features)
+#endif
+
+namespace CpuFeatures {
+    struct Flags {
+        bool sse2  = false;
+        bool ssse3 = false;
+        bool sse41 = false;
+        bool aesni = false;
+        bool pclmul = false;
+        bool avx2  = false;
+        bool shani = false;
+    };
+
+#ifdef CRYPTVAULT_X86
+    inline void cpuid(unsigned int leaf, unsigned int sub, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+        int r[4];
+        __cpuidex(r, (int)leaf, (int)sub);
+        for (int i = 0; i < 4; i++) regs[i] = (unsigned int)r[i];
+#else
+        __cpuid_count(leaf, sub, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    // XCR0 bits 1-2: OS saves XMM/YMM state, required before using AVX
+    CV_TARGET("xsave")
+    inline bool osSavesYmm() {
+        return (_xgetbv(0) & 0x6) == 0x6;
+    }
+#endif
+
+    inline Flags detect() {
+        Flags f;
+#ifdef CRYPTVAULT_X86
+        unsigned int r[4] = {0};
+        cpuid(0, 0, r);
+        unsigned int maxLeaf = r[0];
+        if (maxLeaf >= 1) {
+            cpuid(1, 0, r);
+            f.sse2  = (r[3] >> 26) & 1;   // EDX bit 26
+            f.ssse3 = (r[2] >> 9) & 1;    // ECX bit 9
+            f.sse41 = (r[2] >> 19) & 1;   // ECX bit 19
+            f.aesni = (r[2] >> 25) & 1;   // ECX bit 25
+            f.pclmul = (r[2] >> 1) & 1;   // ECX bit 1
+        }
+        bool ymm = maxLeaf >= 1 && ((r[2] >> 27) & 1) && osSavesYmm();   // OSXSAVE
+        if (maxLeaf >= 7) {
+            cpuid(7, 0, r);
+            f.avx2  = ymm && ((r[1] >> 5) & 1);   // EBX bit 5
+            f.shani = (r[1] >> 29) & 1;           // EBX bit 29
+        }
+#endif
+        return f;
+    }
+
+    // Detected once per process; CPUID is serialising and slow
+    inline const Flags& get() {
+        static const Flags flags = detect();
+        return flags;
+    }
+
+    // Timestamp counter for cycles/byte figures; 0 where unavailable
+    inline unsigned long long readCycleCounter() {
+#ifdef CRYPTVAULT_X86
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+}
@@ -0,0 +1,375 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════
+// Crypto Provider Layer
+// One interface for SHA-256, HMAC-SHA256, PBKDF2-SHA256 and
+// AES-256-GCM with two backends: the native kernels (SHA-NI /
+// AVX2, AES-NI + PCLMULQDQ) and OpenSSL EVP. On first use each
+// backend runs known-answer self-tests; per operation the
+// fastest backend that passed is chosen by a short benchmark.
+// Override with CRYPTVAULT_PROVIDER=native|openssl.
+// Included by crypto_utils.h after the native primitives.
+// ═══════════════════════════════════════════════════════════
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <climits>
+
+namespace CryptoProvider {
+    enum class Op { Sha256 = 0, HmacSha256, Pbkdf2, AesGcm, Count };
+    static const int OP_COUNT = (int)Op::Count;
+
+    inline const char* opName(Op op) {
+        switch (op) {
+            case Op::Sha256:     return "SHA-256";
+            case Op::HmacSha256: return "HMAC-SHA256";
+            case Op::Pbkdf2:     return "PBKDF2-SHA256";
+            default:             return "AES-256-GCM";
+        }
+    }
+
+    // Every operation returns false if the backend failed; the output
+    // (digest, key, ciphertext and tag) must not be used then
+    class Provider {
+    public:
+        virtual ~Provider() {}
+        virtual const char* name() const = 0;
+        virtual bool sha256(const unsigned char* data, size_t len, unsigned char out[32]) const = 0;
+        virtual bool hmacSha256(const unsigned char* key, size_t keyLen, const unsigned char* data, size_t len,
+                                unsigned char out[32]) const = 0;
+        virtual bool pbkdf2Sha256(const unsigned char* pw, size_t pwLen, const unsigned char* salt, size_t saltLen,
+                                  unsigned int iterations, unsigned char* out, size_t outLen) const = 0;
+        virtual bool gcmSeal(const unsigned char key[32], const unsigned char nonce[12],
+                             const unsigned char* aad, size_t aadLen,
+                             unsigned char* data, size_t len, unsigned char tag[16]) const = 0;
+        // On failure `data` must not be used (the OpenSSL backend wipes it)
+        virtual bool gcmOpen(const unsigned char key[32], const unsigned char nonce[12],
+                             const unsigned char* aad, size_t aadLen,
+                             unsigned char* data, size_t len, const unsigned char tag[16]) const = 0;
+    };
+
+    // ─── Native kernels ───
+    class Native : public Provider {
+    public:
+        const char* name() const override { return "native"; }
+        bool sha256(const unsigned char* data, size_t len, unsigned char out[32]) const override {
+            auto h = SHA256Impl::hash(data, len);
+            memcpy(out, h.data(), 32);
+            return true;
+        }
+        bool hmacSha256(const unsigned char* key, size_t keyLen, const unsigned char* data, size_t len,
+                        unsigned char out[32]) const override {
+            HMAC_SHA256 ctx(key, keyLen);
+            ctx.update(data, len);
+            auto mac = ctx.final();
+            memcpy(out, mac.data(), 32);
+            return true;
+        }
+        bool pbkdf2Sha256(const unsigned char* pw, size_t pwLen, const unsigned char* salt, size_t saltLen,
+                          unsigned int iterations, unsigned char* out, size_t outLen) const override {
+            if (iterations > INT_MAX) return false;
+            string password((const char*)pw, pwLen);
+            PBKDF2_SHA256(password).derive(salt, saltLen, (int)iterations, out, outLen);
+            secure_memzero(&password[0], password.size());
+            return true;
+        }
+        bool gcmSeal(const unsigned char key[32], const unsigned char nonce[12], const unsigned char* aad, size_t aadLen,
+                     unsigned char* data, size_t len, unsigned char tag[16]) const override {
+            AES256GCM g; g.setKey(key);
+            g.seal(nonce, aad, aadLen, data, len, tag);
+            return true;
+        }
+        bool gcmOpen(const unsigned char key[32], const unsigned char nonce[12], const unsigned char* aad, size_t aadLen,
+                     unsigned char* data, size_t len, const unsigned char tag[16]) const override {
+            AES256GCM g; g.setKey(key);
+            return g.open(nonce, aad, aadLen, data, len, tag);
+        }
+    };
+
+    // ─── OpenSSL EVP ───
+    class Evp : public Provider {
+        static constexpr size_t STEP = 1u << 30;   // EVP lengths are int
+        static bool gcm(bool encrypt, const unsigned char key[32], const unsigned char nonce[12],
+                        const unsigned char* aad, size_t aadLen, unsigned char* data, size_t len, unsigned char tag[16]) {
+            EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+            if (!ctx) return false;
+            int n = 0;
+            bool ok = EVP_CipherInit_ex(ctx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr, encrypt) == 1
+                   && EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, 12, nullptr) == 1
+                   && EVP_CipherInit_ex(ctx, nullptr, nullptr, key, nonce, encrypt) == 1;
+            for (size_t off = 0; ok && off < aadLen; off += STEP)
+                ok = EVP_CipherUpdate(ctx, nullptr, &n, aad + off, (int)min(STEP, aadLen - off)) == 1;
+            for (size_t off = 0; ok && off < len; off += STEP)
+                ok = EVP_CipherUpdate(ctx, data + off, &n, data + off, (int)min(STEP, len - off)) == 1;
+            if (ok && !encrypt) ok = EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, 16, tag) == 1;
+            unsigned char last[16];
+            ok = ok && EVP_CipherFinal_ex(ctx, last, &n) == 1;
+            if (ok && encrypt) ok = EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, 16, tag) == 1;
+            EVP_CIPHER_CTX_free(ctx);
+            return ok;
+        }
+    public:
+        const char* name() const override { return "openssl"; }
+        bool sha256(const unsigned char* data, size_t len, unsigned char out[32]) const override {
+            if (EVP_Digest(data, len, out, nullptr, EVP_sha256(), nullptr) == 1) return true;
+            memset(out, 0, 32);
+            return false;
+        }
+        bool hmacSha256(const unsigned char* key, size_t keyLen, const unsigned char* data, size_t len,
+                        unsigned char out[32]) const override {
+            unsigned int outLen = 32;
+            if (keyLen <= INT_MAX && HMAC(EVP_sha256(), key, (int)keyLen, data, len, out, &outLen)) return true;
+            memset(out, 0, 32);
+            return false;
+        }
+        bool pbkdf2Sha256(const unsigned char* pw, size_t pwLen, const unsigned char* salt, size_t saltLen,
+                          unsigned int iterations, unsigned char* out, size_t outLen) const override {
+            if (pwLen <= INT_MAX && saltLen <= INT_MAX && outLen <= INT_MAX && iterations <= INT_MAX
+                && PKCS5_PBKDF2_HMAC((const char*)pw, (int)pwLen, salt, (int)saltLen, (int)iterations,
+                                     EVP_sha256(), (int)outLen, out) == 1)
+                return true;
+            secure_memzero(out, outLen);
+            return false;
+        }
+        bool gcmSeal(const unsigned char key[32], const unsigned char nonce[12], const unsigned char* aad, size_t aadLen,
+                     unsigned char* data, size_t len, unsigned char tag[16]) const override {
+            if (gcm(true, key, nonce, aad, aadLen, data, len, tag)) return true;
+            memset(tag, 0, 16);
+            return false;
+        }
+        bool gcmOpen(const unsigned char key[32], const unsigned char nonce[12], const unsigned char* aad, size_t aadLen,
+                     unsigned char* data, size_t len, const unsigned char tag[16]) const override {
+            unsigned char t[16];
+            memcpy(t, tag, 16);
+            if (gcm(false, key, nonce, aad, aadLen, data, len, t)) return true;
+            secure_memzero(data, len);   // EVP decrypts before the tag check
+            return false;
+        }
+    };
+
+    // ─── Known-answer self-tests ───
+    inline bool hexEquals(const unsigned char* got, const char* hex) {
+        auto want = hexToBytes(hex);
+        return constant_time_compare(got, want.data(), want.size());
+    }
+    inline bool selfTest(const Provider& p, Op op) {
+        unsigned char out[64];
+        switch (op) {
+            case Op::Sha256:
+                return p.sha256((const unsigned char*)"abc", 3, out)
+                    && hexEquals(out, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+            case Op::HmacSha256:   // RFC 4231 test case 2
+                return p.hmacSha256((const unsigned char*)"Jefe", 4, (const unsigned char*)"what do ya want for nothing?", 28, out)
+                    && hexEquals(out, "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+            case Op::Pbkdf2:
+                return p.pbkdf2Sha256((const unsigned char*)"password", 8, (const unsigned char*)"salt", 4, 2, out, 32)
+                    && hexEquals(out, "ae4d0c95af6b46d32d0adff928f06dd02a303f8ef3c251dfd6e2d85a95474c43");
+            default: {   // GCM spec test case 14, then a forged tag must be rejected
+                unsigned char key[32] = {0}, nonce[12] = {0}, data[16] = {0}, tag[16];
+                if (!p.gcmSeal(key, nonce, nullptr, 0, data, 16, tag)
+                    || !hexEquals(data, "cea7403d4d606b6e074ec5d3baf39d18")
+                    || !hexEquals(tag, "d0d1c8a799996bf0265b98b5d48ab919")) return false;
+                if (!p.gcmOpen(key, nonce, nullptr, 0, data, 16, tag) || data[0] != 0) return false;
+                if (!p.gcmSeal(key, nonce, nullptr, 0, data, 16, tag)) return false;
+                tag[15] ^= 1;
+                return !p.gcmOpen(key, nonce, nullptr, 0, data, 16, tag);
+            }
+        }
+    }
+
+    // ─── Known-answer tests for the native-only primitives ───
+    // No OpenSSL fallback exists for these, so any failure leaves the
+    // registry unhealthy and init() refuses to run
+    struct NativeTest { const char* name; bool (*run)(); };
+
+    // FIPS-197 C.3 on every AES backend, one block and a 9-block batch
+    // (a full bitsliced pass plus a padded tail)
+    inline bool aesKat() {
+        const char* pt = "00112233445566778899aabbccddeeff";
+        const char* ct = "8ea2b7ca516745bfeafc49904b496089";
+        auto key = hexToBytes("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f");
+        using AES256Impl::Backend;
+        for (Backend b : {Backend::Reference, Backend::TTable, Backend::Bitsliced, Backend::AesNi}) {
+            if (b == Backend::AesNi && !AESNI::available()) continue;
+            AES256Impl::Context ctx;
+            ctx.keyExpansion(key.data(), b);
+            auto block = hexToBytes(pt);
+            ctx.encryptBlock(block.data());
+            if (!hexEquals(block.data(), ct)) return false;
+            ctx.decryptBlock(block.data());
+            if (!hexEquals(block.data(), pt)) return false;
+            vector<unsigned char> batch;
+            for (int i = 0; i < 9; i++) batch.insert(batch.end(), block.begin(), block.end());
+            ctx.encryptBlocks(batch.data(), 9);
+            for (int i = 0; i < 9; i++) if (!hexEquals(batch.data() + i * 16, ct)) return false;
+            ctx.decryptBlocks(batch.data(), 9);
+            for (int i = 0; i < 9; i++) if (!hexEquals(batch.data() + i * 16, pt)) return false;
+        }
+        return true;
+    }
+
+    // RFC 8439 A.1 keystream (zero key and nonce, blocks 0 and 1), then
+    // every block of a 512-byte run through the wide kernels against
+    // the scalar path; and the 2.8.2 AEAD vector with a forged tag
+    inline bool chachaKat() {
+        unsigned char key[32] = {0}, nonce[12] = {0};
+        vector<unsigned char> wide(512, 0);
+        ChaChaImpl::xorStream(key, nonce, 0, wide.data(), wide.size());
+        if (!hexEquals(wide.data(), "76b8e0ada0f13d90405d6ae55386bd28bdd219b8a08ded1aa836efcc8b770dc7"
+                                    "da41597c5157488d7724e03fb8d84a376a43b8f41518a11cc387b669b2ee6586")
+            || !hexEquals(wide.data() + 64, "9f07e7be5551387a98ba977c732d080dcb0f29a048e3656912c6533e32ee7aed"
+                                            "29b721769ce64e43d57133b074d839d531ed1f28510afb45ace10a1f4b794d6f"))
+            return false;
+        for (ChaChaImpl::uint32 block = 0; block < 8; block++) {
+            unsigned char one[64] = {0};
+            ChaChaImpl::xorStream(key, nonce, block, one, 64);
+            if (memcmp(one, wide.data() + block * 64, 64) != 0) return false;
+        }
+
+        auto aeadKey = hexToBytes("808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f");
+        auto aeadNonce = hexToBytes("070000004041424344454647");
+        auto aad = hexToBytes("50515253c0c1c2c3c4c5c6c7");
+        const string pt = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip "
+                          "for the future, sunscreen would be it.";
+        vector<unsigned char> data(pt.begin(), pt.end());
+        unsigned char tag[16];
+        ChaCha20Poly1305 aead;
+        aead.setKey(aeadKey.data());
+        aead.seal(aeadNonce.data(), aad.data(), aad.size(), data.data(), data.size(), tag);
+        if (!hexEquals(data.data(), "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d6"
+                                    "3dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b36"
+                                    "92ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+                                    "3ff4def08e4b7a9de576d26586cec64b6116")
+            || !hexEquals(tag, "1ae10b594f09e26a7e902ecbd0600691")) return false;
+        tag[15] ^= 1;
+        if (aead.open(aeadNonce.data(), aad.data(), aad.size(), data.data(), data.size(), tag)) return false;
+        tag[15] ^= 1;
+        return aead.open(aeadNonce.data(), aad.data(), aad.size(), data.data(), data.size(), tag)
+            && string(data.begin(), data.end()) == pt;
+    }
+
+    // RFC 9106 5.3: t=3, m=32 KiB, p=4 with secret and associated data
+    inline bool argon2Kat() {
+        vector<unsigned char> pwd(32, 0x01), salt(16, 0x02), secret(8, 0x03), ad(12, 0x04);
+        unsigned char tag[32];
+        return Argon2Impl::argon2id(pwd.data(), pwd.size(), salt.data(), salt.size(), 3, 32, 4, tag, 32,
+                                    secret.data(), secret.size(), ad.data(), ad.size())
+            && hexEquals(tag, "0d640df58d78766c08c037a34a8b53c9d01ef0452d75b65eb52520e96b01e659");
+    }
+
+    inline const vector<NativeTest>& nativeTests() {
+        static const vector<NativeTest> tests = {
+            {"AES-256", aesKat},
+            {"ChaCha20-Poly1305", chachaKat},
+            {"Argon2id", argon2Kat},
+            {"ChaCha20 DRBG", Drbg::selfTest},
+        };
+        return tests;
+    }
+
+    // Seconds for one representative call: 256 KB for the bulk
+    // operations, a 64-byte key at 2000 iterations for PBKDF2
+    inline double timeOp(const Provider& p, Op op) {
+        static vector<unsigned char> buf(256 * 1024, 0x5a);
+        unsigned char key[32] = {1}, nonce[12] = {0}, out[64];
+        double best = 1e9;
+        for (int run = 0; run < 3; run++) {
+            auto t0 = chrono::steady_clock::now();
+            switch (op) {
+                case Op::Sha256:     (void)p.sha256(buf.data(), buf.size(), out); break;
+                case Op::HmacSha256: (void)p.hmacSha256(key, 32, buf.data(), buf.size(), out); break;
+                case Op::Pbkdf2:     (void)p.pbkdf2Sha256(key, 32, nonce, 12, 2000, out, 64); break;
+                default:             (void)p.gcmSeal(key, nonce, nullptr, 0, buf.data(), buf.size(), out); break;
+            }
+            best = min(best, chrono::duration<double>(chrono::steady_clock::now() - t0).count());
+        }
+        return best;
+    }
+
+    struct Registry {
+        Native native;
+        Evp evp;
+        const Provider* providers[2] = {&native, &evp};
+        const Provider* chosen[OP_COUNT];
+        bool passed[2][OP_COUNT];
+        double seconds[2][OP_COUNT];
+        vector<const char*> nativeFailed;
+        bool healthy = true;
+        Registry() {
+            for (const auto& t : nativeTests())
+                if (!t.run()) { nativeFailed.push_back(t.name); healthy = false; }
+            const char* env = getenv("CRYPTVAULT_PROVIDER");
+            string forced = env ? env : "";
+            for (int op = 0; op < OP_COUNT; op++) {
+                chosen[op] = &native;
+                for (int i = 0; i < 2; i++) {
+                    passed[i][op] = selfTest(*providers[i], (Op)op);
+                    seconds[i][op] = passed[i][op] ? timeOp(*providers[i], (Op)op) : 0;
+                }
+                int pick = -1;
+                for (int i = 0; i < 2; i++) {
+                    if (!passed[i][op]) continue;
+                    if (forced == providers[i]->name()) { pick = i; break; }
+                    if (pick < 0 || seconds[i][op] < seconds[pick][op]) pick = i;
+                }
+                if (pick < 0) healthy = false;
+                else chosen[op] = providers[pick];
+            }
+        }
+    };
+    inline Registry& registry() {
+        static Registry r;
+        return r;
+    }
+    // Run the self-tests and selection now; false if an operation has no working
+    // backend or a native-only primitive fails its known-answer test
+    inline bool init() {
+        Registry& r = registry();
+        for (int op = 0; op < OP_COUNT; op++)
+            for (int i = 0; i < 2; i++)
+                if (!r.passed[i][op])
+                    cerr << "❌ Self-test failed: " << opName((Op)op) << " (" << r.providers[i]->name() << ")" << endl;
+        for (const char* name : r.nativeFailed)
+            cerr << "❌ Self-test failed: " << name << " (native)" << endl;
+        return r.healthy;
+    }
+    inline const Provider& get(Op op) { return *registry().chosen[(int)op]; }
+
+    // Selected backend per operation with both measurements, for --benchmark
+    inline void report(ostream& os) {
+        Registry& r = registry();
+        os << "  " << setw(16) << left << "Operation" << setw(14) << "Native" << setw(14) << "OpenSSL" << "Selected" << endl;
+        os << "  " << string(52, '-') << endl;
+        for (int op = 0; op < OP_COUNT; op++) {
+            os << "  " << setw(16) << left << opName((Op)op);
+            for (int i = 0; i < 2; i++) {
+                stringstream cell;
+                if (!r.passed[i][op]) cell << "FAILED";
+                else if (op == (int)Op::Pbkdf2) cell << fixed << setprecision(0) << 2000 / r.seconds[i][op] / 1000 << "k it/s";
+                else cell << fixed << setprecision(0) << 0.25 / r.seconds[i][op] << " MB/s";
+                os << setw(14) << cell.str();
+            }
+            os << r.chosen[op]->name() << endl;
+        }
+    }
+
+    // ─── Dispatch ───
+    inline bool sha256(const unsigned char* data, size_t len, unsigned char out[32]) {
+        return get(Op::Sha256).sha256(data, len, out);
+    }
+    inline bool hmacSha256(const unsigned char* key, size_t keyLen, const unsigned char* data, size_t len,
+                           unsigned char out[32]) {
+        return get(Op::HmacSha256).hmacSha256(key, keyLen, data, len, out);
+    }
+    inline bool pbkdf2Sha256(const string& password, const unsigned char* salt, size_t saltLen,
+                             unsigned int iterations, unsigned char* out, size_t outLen) {
+        return get(Op::Pbkdf2).pbkdf2Sha256((const unsigned char*)password.data(), password.size(), salt, saltLen,
+                                            iterations, out, outLen);
+    }
+    inline bool gcmSeal(const unsigned char key[32], const unsigned char nonce[12], const unsigned char* aad, size_t aadLen,
+                        unsigned char* data, size_t len, unsigned char tag[16]) {
+        return get(Op::AesGcm).gcmSeal(key, nonce, aad, aadLen, data, len, tag);
+    }
+    inline bool gcmOpen(const unsigned char key[32], const unsigned char nonce[12], const unsigned char* aad, size_t aadLen,
+                        unsigned char* data, size_t len, const unsigned char tag[16]) {
+        return get(Op::AesGcm).gcmOpen(key, nonce, aad, aadLen, data, len, tag);
+    }
+}
@@ -3,7 +3,21 @@
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <iomanip>
 #include <cstring>
+#include <cmath>
+#include <chrono>
+#include <array>
+#include <memory>
+#include <map>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <sys/stat.h>
 #ifdef _WIN32
 #include <winsock2.h>
 #include <windows.h>
@@ -11,111 +25,28 @@
 #include <sys/file.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <cerrno>
+#include <sys/mman.h>
+#endif
+#if defined(__linux__)
+#include <sys/random.h>
 #endif
 #include <filesystem>
 #include "../src/eth_logger.hpp"
+#include "sha256.h"
+#include "aes_ni.h"
+#include "aes_bitslice.h"
+#include "ghash.h"
+#include "chacha20_poly1305.h"
+#include "argon2.h"
 extern std::unique_ptr<EthLogger> ethLogger;
 
 using namespace std;
 // ═══════════════════════════════════════════════════════════
-// SHA-256 Implementation
-// ═══════════════════════════════════════════════════════════
-namespace SHA256Impl {
-    typedef unsigned int uint32;
-    typedef unsigned long long uint64;
-    static const uint32 K[64] = {
-        0x428a2f98,0x71374491,0xb5c0fbcf,0xe9b5dba5,0x3956c25b,0x59f111f1,0x923f82a4,0xab1c5ed5,
-        0xd807aa98,0x12835b01,0x243185be,0x550c7dc3,0x72be5d74,0x80deb1fe,0x9bdc06a7,0xc19bf174,
-        0xe49b69c1,0xefbe4786,0x0fc19dc6,0x240ca1cc,0x2de92c6f,0x4a7484aa,0x5cb0a9dc,0x76f988da,
-        0x983e5152,0xa831c66d,0xb00327c8,0xbf597fc7,0xc6e00bf3,0xd5a79147,0x06ca6351,0x14292967,
-        0x27b70a85,0x2e1b2138,0x4d2c6dfc,0x53380d13,0x650a7354,0x766a0abb,0x81c2c92e,0x92722c85,
-        0xa2bfe8a1,0xa81a664b,0xc24b8b70,0xc76c51a3,0xd192e819,0xd6990624,0xf40e3585,0x106aa070,
-        0x19a4c116,0x1e376c08,0x2748774c,0x34b0bcb5,0x391c0cb3,0x4ed8aa4a,0x5b9cca4f,0x682e6ff3,
-        0x748f82ee,0x78a5636f,0x84c87814,0x8cc70208,0x90befffa,0xa4506ceb,0xbef9a3f7,0xc67178f2
-    };
-    inline uint32 rotr(uint32 x, int n) { return (x >> n) | (x << (32 - n)); }
-    inline uint32 ch(uint32 x, uint32 y, uint32 z) { return (x & y) ^ (~x & z); }
-    inline uint32 maj(uint32 x, uint32 y, uint32 z) { return (x & y) ^ (x & z) ^ (y & z); }
-    inline uint32 sig0(uint32 x) { return rotr(x, 2) ^ rotr(x, 13) ^ rotr(x, 22); }
-    inline uint32 sig1(uint32 x) { return rotr(x, 6) ^ rotr(x, 11) ^ rotr(x, 25); }
-    inline uint32 gam0(uint32 x) { return rotr(x, 7) ^ rotr(x, 18) ^ (x >> 3); }
-    inline uint32 gam1(uint32 x) { return rotr(x, 17) ^ rotr(x, 19) ^ (x >> 10); }
-
-    class Hasher {
-        uint32 states[8];
-        unsigned char buffer[64];
-        uint64 bitlen;
-        size_t bufferLen;
-        void processBlock(const unsigned char* b) {
-            uint32 w[64];
-            for (int i = 0; i < 16; i++)
-                w[i] = ((uint32)b[i*4]<<24)|((uint32)b[i*4+1]<<16)|((uint32)b[i*4+2]<<8)|b[i*4+3];
-            for (int i = 16; i < 64; i++)
-                w[i] = gam1(w[i-2]) + w[i-7] + gam0(w[i-15]) + w[i-16];
-            uint32 a=states[0],b1=states[1],c=states[2],d=states[3],e=states[4],f=states[5],g=states[6],hh=states[7];
-            for (int i = 0; i < 64; i++) {
-                uint32 t1 = hh + sig1(e) + ch(e,f,g) + K[i] + w[i];
-                uint32 t2 = sig0(a) + maj(a,b1,c);
-                hh=g; g=f; f=e; e=d+t1; d=c; c=b1; b1=a; a=t1+t2;
-            }
-            states[0]+=a;states[1]+=b1;states[2]+=c;states[3]+=d;states[4]+=e;states[5]+=f;states[6]+=g;states[7]+=hh;
-        }
-    public:
-        Hasher() { reset(); }
-        void reset() {
-            states[0]=0x6a09e667; states[1]=0xbb67ae85; states[2]=0x3c6ef372; states[3]=0xa54ff53a;
-            states[4]=0x510e527f; states[5]=0x9b05688c; states[6]=0x1f83d9ab; states[7]=0x5be0cd19;
-            bitlen = 0; bufferLen = 0;
-        }
-        void update(const unsigned char* data, size_t len) {
-            for (size_t i = 0; i < len; i++) {
-                buffer[bufferLen++] = data[i];
-                if (bufferLen == 64) {
-                    processBlock(buffer);
-                    bitlen += 512;
-                    bufferLen = 0;
-                }
-            }
-        }
-        vector<unsigned char> final() {
-            uint64 totalBitLen = bitlen + bufferLen * 8;
-            buffer[bufferLen++] = 0x80;
-            if (bufferLen > 56) {
-                while (bufferLen < 64) buffer[bufferLen++] = 0x00;
-                processBlock(buffer);
-                bufferLen = 0;
-            }
-            while (bufferLen < 56) buffer[bufferLen++] = 0x00;
-            for (int i = 7; i >= 0; i--) buffer[56 + (7 - i)] = (unsigned char)(totalBitLen >> (i * 8));
-            processBlock(buffer);
-            vector<unsigned char> res(32);
-            for (int i = 0; i < 8; i++) {
-                res[i*4]=(states[i]>>24)&0xff; res[i*4+1]=(states[i]>>16)&0xff;
-                res[i*4+2]=(states[i]>>8)&0xff; res[i*4+3]=states[i]&0xff;
-            }
-            return res;
-        }
-    };
-
-    static inline vector<unsigned char> hash(const unsigned char* data, size_t len) {
-        Hasher h;
-        h.update(data, len);
-        return h.final();
-    }
-    static inline vector<unsigned char> hash(const string& s) {
-        return hash((const unsigned char*)s.data(), s.size());
-    }
-    static string toHex(const vector<unsigned char>& h) {
-        stringstream ss;
-        for (auto b : h) ss << hex << setfill('0') << setw(2) << (int)b;
-        return ss.str();
-    }
-}
-// ═══════════════════════════════════════════════════════════
 // AES-256 Implementation
 // ═══════════════════════════════════════════════════════════
 namespace AES256Impl {
-    static const unsigned char sbox[256] = {
+    static constexpr unsigned char sbox[256] = {
         0x63,0x7c,0x77,0x7b,0xf2,0x6b,0x6f,0xc5,0x30,0x01,0x67,0x2b,0xfe,0xd7,0xab,0x76,
         0xca,0x82,0xc9,0x7d,0xfa,0x59,0x47,0xf0,0xad,0xd4,0xa2,0xaf,0x9c,0xa4,0x72,0xc0,
         0xb7,0xfd,0x93,0x26,0x36,0x3f,0xf7,0xcc,0x34,0xa5,0xe5,0xf1,0x71,0xd8,0x31,0x15,
@@ -133,7 +64,7 @@ namespace AES256Impl {
         0xe1,0xf8,0x98,0x11,0x69,0xd9,0x8e,0x94,0x9b,0x1e,0x87,0xe9,0xce,0x55,0x28,0xdf,
         0x8c,0xa1,0x89,0x0d,0xbf,0xe6,0x42,0x68,0x41,0x99,0x2d,0x0f,0xb0,0x54,0xbb,0x16
     };
-    static const unsigned char rsbox[256] = {
+    static constexpr unsigned char rsbox[256] = {
         0x52,0x09,0x6a,0xd5,0x30,0x36,0xa5,0x38,0xbf,0x40,0xa3,0x9e,0x81,0xf3,0xd7,0xfb,
         0x7c,0xe3,0x39,0x82,0x9b,0x2f,0xff,0x87,0x34,0x8e,0x43,0x44,0xc4,0xde,0xe9,0xcb,
         0x54,0x7b,0x94,0x32,0xa6,0xc2,0x23,0x3d,0xee,0x4c,0x95,0x0b,0x42,0xfa,0xc3,0x4e,
@@ -151,9 +82,9 @@ namespace AES256Impl {
         0xa0,0xe0,0x3b,0x4d,0xae,0x2a,0xf5,0xb0,0xc8,0xeb,0xbb,0x3c,0x83,0x53,0x99,0x61,
         0x17,0x2b,0x04,0x7e,0xba,0x77,0xd6,0x26,0xe1,0x69,0x14,0x63,0x55,0x21,0x0c,0x7d
     };
-    static const unsigned char rcon[11] = {0x00,0x01,0x02,0x04,0x08,0x10,0x20,0x40,0x80,0x1b,0x36};
-    static unsigned char xtime(unsigned char x) { return (x<<1) ^ ((x>>7) & 1 ? 0x1b : 0); }
-    static unsigned char gmul(unsigned char a, unsigned char b) {
+    static constexpr unsigned char rcon[11] = {0x00,0x01,0x02,0x04,0x08,0x10,0x20,0x40,0x80,0x1b,0x36};
+    static constexpr unsigned char xtime(unsigned char x) { return (x<<1) ^ ((x>>7) & 1 ? 0x1b : 0); }
+    static constexpr unsigned char gmul(unsigned char a, unsigned char b) {
         unsigned char p = 0;
         for (int i = 0; i < 8; i++) {
             if (b & 1) p ^= a;
@@ -162,11 +93,81 @@ namespace AES256Impl {
         }
         return p;
     }
+    // ── T-tables: SubBytes+ShiftRows+MixColumns fused per 32-bit column ──
+    // Te[r][x] = (2*S[x], S[x], S[x], 3*S[x]) rotated right by 8*r bits,
+    // Td[r][x] = (14*Si[x], 9*Si[x], 13*Si[x], 11*Si[x]) likewise.
+    // Built from sbox/rsbox at compile time, no runtime init.
+    typedef unsigned int uint32;
+    struct TTables { uint32 Te[4][256]; uint32 Td[4][256]; };
+    static constexpr uint32 rotrWord(uint32 x, int n) { return n == 0 ? x : (x >> n) | (x << (32 - n)); }
+    static constexpr TTables buildTTables() {
+        TTables t{};
+        for (int x = 0; x < 256; x++) {
+            unsigned char s = sbox[x], si = rsbox[x];
+            uint32 e = ((uint32)gmul(s,2)<<24) | ((uint32)s<<16) | ((uint32)s<<8) | gmul(s,3);
+            uint32 d = ((uint32)gmul(si,14)<<24) | ((uint32)gmul(si,9)<<16) | ((uint32)gmul(si,13)<<8) | gmul(si,11);
+            for (int r = 0; r < 4; r++) {
+                t.Te[r][x] = rotrWord(e, 8*r);
+                t.Td[r][x] = rotrWord(d, 8*r);
+            }
+        }
+        return t;
+    }
+    static constexpr TTables ttables = buildTTables();
+    static_assert(ttables.Te[0][0] == 0xc66363a5 && ttables.Td[0][0] == 0x51f4a750, "AES T-table generation");
+
+    static inline uint32 load32be(const unsigned char* p) {
+        return ((uint32)p[0]<<24) | ((uint32)p[1]<<16) | ((uint32)p[2]<<8) | p[3];
+    }
+    static inline void store32be(unsigned char* p, uint32 v) {
+        p[0] = (unsigned char)(v>>24); p[1] = (unsigned char)(v>>16); p[2] = (unsigned char)(v>>8); p[3] = (unsigned char)v;
+    }
+
+    // Reference: byte-wise state machine, kept for comparison in runBenchmarks()
+    // Bitsliced: constant-time, 8 blocks per call (see aes_bitslice.h)
+    // TTable: faster, but its key-dependent lookups leak through the cache
+    enum class Backend { Reference, TTable, Bitsliced, AesNi };
+    // AES-NI when present, else Bitsliced; T-table only on request.
+    // CRYPTVAULT_AES_BACKEND=reference|ttable|bitsliced|aesni overrides detection
+    inline Backend bestBackend() {
+        static const Backend chosen = [] {
+            const char* env = getenv("CRYPTVAULT_AES_BACKEND");
+            string want = env ? env : "";
+            if (want == "reference") return Backend::Reference;
+            if (want == "ttable") return Backend::TTable;
+            if (want == "bitsliced") return Backend::Bitsliced;
+            return AESNI::available() ? Backend::AesNi : Backend::Bitsliced;
+        }();
+        return chosen;
+    }
+    inline const char* backendName(Backend b) {
+        switch (b) {
+            case Backend::AesNi:     return "AES-NI";
+            case Backend::Bitsliced: return "Bitsliced";
+            case Backend::TTable:    return "T-table";
+            default:                 return "Reference";
+        }
+    }
+
     struct Context {
         unsigned char roundKey[240];
+        unsigned char invRoundKey[240]; // AESIMC schedule, only filled for AesNi
+        uint32 encWords[60];            // T-table schedules (decryption uses
+        uint32 decWords[60];            // the equivalent inverse cipher)
+        unsigned long long bsKeys[120]; // bitsliced schedule, 8 words per round
         int Nr; // 14 rounds for AES-256
-        void keyExpansion(const unsigned char key[32]) {
+        Backend backend = Backend::Reference;
+        void keyExpansion(const unsigned char key[32]) { keyExpansion(key, bestBackend()); }
+        void keyExpansion(const unsigned char key[32], Backend wanted) {
             Nr = 14;
+            backend = wanted;
+            if (backend == Backend::AesNi && !AESNI::available()) backend = Backend::Bitsliced;
+#ifdef CRYPTVAULT_X86
+            if (backend == Backend::AesNi) {
+                AESNI::expandKey256(key, roundKey, invRoundKey);
+                return;
+            }
+#endif
             int Nk = 8;
             memcpy(roundKey, key, 32);
             for (int i = Nk; i < 4 * (Nr + 1); i++) {
@@ -184,6 +185,20 @@ namespace AES256Impl {
                 for (int j = 0; j < 4; j++)
                     roundKey[i*4+j] = roundKey[(i-Nk)*4+j] ^ temp[j];
             }
+            if (backend == Backend::TTable) {
+                for (int i = 0; i < 4 * (Nr + 1); i++) encWords[i] = load32be(roundKey + i*4);
+                // Reverse round order; InvMixColumns on inner rounds via Td[sbox[b]]
+                for (int r = 0; r <= Nr; r++) {
+                    for (int c = 0; c < 4; c++) {
+                        uint32 w = encWords[(Nr - r)*4 + c];
+                        if (r > 0 && r < Nr)
+                            w = ttables.Td[0][sbox[w>>24]] ^ ttables.Td[1][sbox[(w>>16)&0xff]] ^
+                                ttables.Td[2][sbox[(w>>8)&0xff]] ^ ttables.Td[3][sbox[w&0xff]];
+                        decWords[r*4 + c] = w;
+                    }
+                }
+            }
+            if (backend == Backend::Bitsliced) AESBitslice::expandKeys(roundKey, Nr, bsKeys);
         }
         void addRoundKey(unsigned char state[4][4], int round) {
             for (int i = 0; i < 4; i++)
@@ -230,7 +245,51 @@ namespace AES256Impl {
                 state[3][i] = gmul(a[0],11)^gmul(a[1],13)^gmul(a[2],9)^gmul(a[3],14);
             }
         }
+        void encryptBlockTTable(unsigned char block[16]) const {
+            const uint32 (&Te)[4][256] = ttables.Te;
+            const uint32* rk = encWords;
+            uint32 s0 = load32be(block) ^ rk[0], s1 = load32be(block+4) ^ rk[1];
+            uint32 s2 = load32be(block+8) ^ rk[2], s3 = load32be(block+12) ^ rk[3];
+            for (int round = 1; round < Nr; round++) {
+                rk += 4;
+                uint32 t0 = Te[0][s0>>24] ^ Te[1][(s1>>16)&0xff] ^ Te[2][(s2>>8)&0xff] ^ Te[3][s3&0xff] ^ rk[0];
+                uint32 t1 = Te[0][s1>>24] ^ Te[1][(s2>>16)&0xff] ^ Te[2][(s3>>8)&0xff] ^ Te[3][s0&0xff] ^ rk[1];
+                uint32 t2 = Te[0][s2>>24] ^ Te[1][(s3>>16)&0xff] ^ Te[2][(s0>>8)&0xff] ^ Te[3][s1&0xff] ^ rk[2];
+                uint32 t3 = Te[0][s3>>24] ^ Te[1][(s0>>16)&0xff] ^ Te[2][(s1>>8)&0xff] ^ Te[3][s2&0xff] ^ rk[3];
+                s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+            }
+            rk += 4;
+            // Final round: no MixColumns, plain S-box
+            store32be(block,    (((uint32)sbox[s0>>24]<<24) | ((uint32)sbox[(s1>>16)&0xff]<<16) | ((uint32)sbox[(s2>>8)&0xff]<<8) | sbox[s3&0xff]) ^ rk[0]);
+            store32be(block+4,  (((uint32)sbox[s1>>24]<<24) | ((uint32)sbox[(s2>>16)&0xff]<<16) | ((uint32)sbox[(s3>>8)&0xff]<<8) | sbox[s0&0xff]) ^ rk[1]);
+            store32be(block+8,  (((uint32)sbox[s2>>24]<<24) | ((uint32)sbox[(s3>>16)&0xff]<<16) | ((uint32)sbox[(s0>>8)&0xff]<<8) | sbox[s1&0xff]) ^ rk[2]);
+            store32be(block+12, (((uint32)sbox[s3>>24]<<24) | ((uint32)sbox[(s0>>16)&0xff]<<16) | ((uint32)sbox[(s1>>8)&0xff]<<8) | sbox[s2&0xff]) ^ rk[3]);
+        }
+        void decryptBlockTTable(unsigned char block[16]) const {
+            const uint32 (&Td)[4][256] = ttables.Td;
+            const uint32* rk = decWords;
+            uint32 s0 = load32be(block) ^ rk[0], s1 = load32be(block+4) ^ rk[1];
+            uint32 s2 = load32be(block+8) ^ rk[2], s3 = load32be(block+12) ^ rk[3];
+            for (int round = 1; round < Nr; round++) {
+                rk += 4;
+                uint32 t0 = Td[0][s0>>24] ^ Td[1][(s3>>16)&0xff] ^ Td[2][(s2>>8)&0xff] ^ Td[3][s1&0xff] ^ rk[0];
+                uint32 t1 = Td[0][s1>>24] ^ Td[1][(s0>>16)&0xff] ^ Td[2][(s3>>8)&0xff] ^ Td[3][s2&0xff] ^ rk[1];
+                uint32 t2 = Td[0][s2>>24] ^ Td[1][(s1>>16)&0xff] ^ Td[2][(s0>>8)&0xff] ^ Td[3][s3&0xff] ^ rk[2];
+                uint32 t3 = Td[0][s3>>24] ^ Td[1][(s2>>16)&0xff] ^ Td[2][(s1>>8)&0xff] ^ Td[3][s0&0xff] ^ rk[3];
+                s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+            }
+            rk += 4;
+            store32be(block,    (((uint32)rsbox[s0>>24]<<24) | ((uint32)rsbox[(s3>>16)&0xff]<<16) | ((uint32)rsbox[(s2>>8)&0xff]<<8) | rsbox[s1&0xff]) ^ rk[0]);
+            store32be(block+4,  (((uint32)rsbox[s1>>24]<<24) | ((uint32)rsbox[(s0>>16)&0xff]<<16) | ((uint32)rsbox[(s3>>8)&0xff]<<8) | rsbox[s2&0xff]) ^ rk[1]);
+            store32be(block+8,  (((uint32)rsbox[s2>>24]<<24) | ((uint32)rsbox[(s1>>16)&0xff]<<16) | ((uint32)rsbox[(s0>>8)&0xff]<<8) | rsbox[s3&0xff]) ^ rk[2]);
+            store32be(block+12, (((uint32)rsbox[s3>>24]<<24) | ((uint32)rsbox[(s2>>16)&0xff]<<16) | ((uint32)rsbox[(s1>>8)&0xff]<<8) | rsbox[s0&0xff]) ^ rk[3]);
+        }
         void encryptBlock(unsigned char block[16]) {
+#ifdef CRYPTVAULT_X86
+            if (backend == Backend::AesNi) { AESNI::encryptBlock(roundKey, block); return; }
+#endif
+            if (backend == Backend::TTable) { encryptBlockTTable(block); return; }
+            if (backend == Backend::Bitsliced) { cryptBitsliced(block, 1, false); return; }
             unsigned char state[4][4];
             for (int i = 0; i < 4; i++)
                 for (int j = 0; j < 4; j++)
@@ -245,6 +304,11 @@ namespace AES256Impl {
                     block[i*4+j] = state[j][i];
         }
         void decryptBlock(unsigned char block[16]) {
+#ifdef CRYPTVAULT_X86
+            if (backend == Backend::AesNi) { AESNI::decryptBlock(invRoundKey, block); return; }
+#endif
+            if (backend == Backend::TTable) { decryptBlockTTable(block); return; }
+            if (backend == Backend::Bitsliced) { cryptBitsliced(block, 1, true); return; }
             unsigned char state[4][4];
             for (int i = 0; i < 4; i++)
                 for (int j = 0; j < 4; j++)
@@ -258,12 +322,40 @@ namespace AES256Impl {
                 for (int j = 0; j < 4; j++)
                     block[i*4+j] = state[j][i];
         }
+        // Partial batches are padded, so a lone block costs a full 8-block pass
+        void cryptBitsliced(unsigned char* data, size_t nBlocks, bool decrypt) {
+            const size_t batch = AESBitslice::BLOCKS * 16;
+            size_t off = 0, len = nBlocks * 16;
+            for (; off + batch <= len; off += batch) AESBitslice::crypt8(bsKeys, Nr, data + off, decrypt);
+            if (off < len) {
+                unsigned char tail[AESBitslice::BLOCKS * 16] = {0};
+                memcpy(tail, data + off, len - off);
+                AESBitslice::crypt8(bsKeys, Nr, tail, decrypt);
+                memcpy(data + off, tail, len - off);
+            }
+        }
+        // ECB over independent blocks (CTR keystream, CBC decryption)
+        void encryptBlocks(unsigned char* data, size_t nBlocks) {
+            if (backend == Backend::Bitsliced) { cryptBitsliced(data, nBlocks, false); return; }
+#ifdef CRYPTVAULT_X86
+            if (backend == Backend::AesNi) { AESNI::cryptBlocks(roundKey, data, nBlocks, false); return; }
+#endif
+            for (size_t i = 0; i < nBlocks; i++) encryptBlock(data + i*16);
+        }
+        void decryptBlocks(unsigned char* data, size_t nBlocks) {
+            if (backend == Backend::Bitsliced) { cryptBitsliced(data, nBlocks, true); return; }
+#ifdef CRYPTVAULT_X86
+            if (backend == Backend::AesNi) { AESNI::cryptBlocks(invRoundKey, data, nBlocks, true); return; }
+#endif
+            for (size_t i = 0; i < nBlocks; i++) decryptBlock(data + i*16);
+        }
     };
 }
 // ═══════════════════════════════════════════════════════════
 // Utility Functions
 // ═══════════════════════════════════════════════════════════
-inline bool generateRandomBytes(unsigned char* buf, size_t len) {
+// Kernel randomness; only used to seed and reseed the per-thread DRBG below
+inline bool osRandomBytes(unsigned char* buf, size_t len) {
 #ifdef _WIN32
     HCRYPTPROV hProv;
     if (!CryptAcquireContext(&hProv, NULL, NULL, PROV_RSA_AES, CRYPT_VERIFYCONTEXT)) return false;
@@ -271,24 +363,152 @@ inline bool generateRandomBytes(unsigned char* buf, size_t len) {
     CryptReleaseContext(hProv, 0);
     return result != 0;
 #else
+#if defined(__linux__)
+    while (len > 0) {
+        ssize_t n = getrandom(buf, len, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == ENOSYS) break;   // pre-3.17 kernel: fall back to /dev/urandom
+            return false;
+        }
+        buf += n; len -= (size_t)n;
+    }
+    if (len == 0) return true;
+#endif
     ifstream rnd("/dev/urandom", ios::binary);
     if (!rnd.is_open()) return false;
     rnd.read((char*)buf, len);
     return rnd.good();
 #endif
 }
-inline vector<unsigned char> pkcs7Pad(const vector<unsigned char>& data) {
-    size_t padLen = 16 - (data.size() % 16);
-    vector<unsigned char> padded = data;
-    padded.insert(padded.end(), padLen, (unsigned char)padLen);
-    return padded;
+// ─── Per-thread ChaCha20 DRBG ───
+// Fast-key-erasure construction: each request is served from the keystream of
+// the current key, whose block 0 becomes the next key, so earlier outputs
+// cannot be recovered from a later state. Small requests draw on a buffered
+// block; large ones (shred passes) are generated in place at ChaCha20 speed.
+// One instance per thread, so no locking. Reseeded from the OS every
+// RESEED_BYTES of output and after fork().
+class Drbg {
+    static const size_t BUF_SIZE = 256;
+    static const size_t RESEED_BYTES = 16u << 20;
+    static const size_t MAX_REQUEST = 1u << 30;   // keeps the 32-bit block counter in range
+    unsigned char key[32];
+    unsigned char buf[BUF_SIZE];
+    size_t avail = 0;
+    size_t sinceReseed = 0;
+    bool seeded = false;
+#ifndef _WIN32
+    pid_t pid = 0;
+#endif
+    bool reseed() {
+        unsigned char fresh[32];
+        if (!osRandomBytes(fresh, sizeof(fresh))) return false;
+        for (int i = 0; i < 32; i++) key[i] = (seeded ? key[i] : 0) ^ fresh[i];
+        ChaChaImpl::wipe(fresh, sizeof(fresh));
+        ChaChaImpl::wipe(buf, sizeof(buf));
+        avail = 0;
+        sinceReseed = 0;
+        seeded = true;
+#ifndef _WIN32
+        pid = getpid();
+#endif
+        return true;
+    }
+    // Keystream blocks 1.. into out, block 0 replaces the key
+    void stream(unsigned char* out, size_t len) {
+        static const unsigned char nonce[12] = {0};
+        unsigned char next[32] = {0};
+        memset(out, 0, len);
+        ChaChaImpl::xorStream(key, nonce, 1, out, len);
+        ChaChaImpl::xorStream(key, nonce, 0, next, 32);
+        memcpy(key, next, 32);
+        ChaChaImpl::wipe(next, sizeof(next));
+        sinceReseed += len;
+    }
+public:
+    Drbg() = default;
+    Drbg(const Drbg&) = delete;
+    Drbg& operator=(const Drbg&) = delete;
+    ~Drbg() {
+        ChaChaImpl::wipe(key, sizeof(key));
+        ChaChaImpl::wipe(buf, sizeof(buf));
+    }
+    bool generate(unsigned char* out, size_t len) {
+        bool stale = !seeded || sinceReseed >= RESEED_BYTES;
+#ifndef _WIN32
+        stale = stale || pid != getpid();
+#endif
+        if (stale && !reseed()) return false;
+        if (len >= BUF_SIZE) {
+            while (len > 0) {
+                size_t n = len < MAX_REQUEST ? len : MAX_REQUEST;
+                stream(out, n);
+                out += n; len -= n;
+            }
+            return true;
+        }
+        if (avail < len) { stream(buf, BUF_SIZE); avail = BUF_SIZE; }
+        unsigned char* src = buf + BUF_SIZE - avail;
+        memcpy(out, src, len);
+        ChaChaImpl::wipe(src, len);
+        avail -= len;
+        return true;
+    }
+    static Drbg& local() {
+        thread_local Drbg drbg;
+        return drbg;
+    }
+    // Known answer from a zero key (RFC 8439 A.1): output starts at keystream
+    // block 1 and the next key is block 0, on both the buffered and the
+    // in-place path
+    static bool selfTest() {
+        static const unsigned char block0[32] = {
+            0x76,0xb8,0xe0,0xad,0xa0,0xf1,0x3d,0x90,0x40,0x5d,0x6a,0xe5,0x53,0x86,0xbd,0x28,
+            0xbd,0xd2,0x19,0xb8,0xa0,0x8d,0xed,0x1a,0xa8,0x36,0xef,0xcc,0x8b,0x77,0x0d,0xc7};
+        static const unsigned char block1[16] = {
+            0x9f,0x07,0xe7,0xbe,0x55,0x51,0x38,0x7a,0x98,0xba,0x97,0x7c,0x73,0x2d,0x08,0x0d};
+        for (size_t len : {(size_t)16, BUF_SIZE}) {
+            Drbg d;
+            memset(d.key, 0, sizeof(d.key));
+            d.seeded = true;
+#ifndef _WIN32
+            d.pid = getpid();
+#endif
+            unsigned char out[BUF_SIZE];
+            if (!d.generate(out, len) || memcmp(out, block1, 16) != 0 || memcmp(d.key, block0, 32) != 0)
+                return false;
+        }
+        return true;
+    }
+};
+inline bool generateRandomBytes(unsigned char* buf, size_t len) {
+    return Drbg::local().generate(buf, len);
+}
+// Uniform integer in [0, bound) without modulo bias; false if no randomness was available
+inline bool randomBelow(unsigned int bound, unsigned int& out) {
+    out = 0;
+    if (bound < 2) return true;
+    unsigned int limit = 0xFFFFFFFFu - 0xFFFFFFFFu % bound, r;
+    do {
+        unsigned char b[4];
+        if (!generateRandomBytes(b, 4)) return false;
+        r = (unsigned int)b[0] | (unsigned int)b[1] << 8 | (unsigned int)b[2] << 16 | (unsigned int)b[3] << 24;
+    } while (r >= limit);
+    out = r % bound;
+    return true;
+}
+// Length of the PKCS#7 padding ending `data`, 0 if malformed
+inline size_t pkcs7PadLength(const unsigned char* data, size_t len) {
+    if (len == 0 || len % 16 != 0) return 0;
+    unsigned char pad = data[len - 1];
+    if (pad < 1 || pad > 16) return 0;
+    for (size_t i = len - pad; i < len; i++)
+        if (data[i] != pad) return 0;
+    return pad;
 }
 inline bool pkcs7Unpad(vector<unsigned char>& data) {
-    if (data.empty() || data.size() % 16 != 0) return false;
-    unsigned char pad = data.back();
-    if (pad < 1 || pad > 16) return false;
-    for (size_t i = data.size() - pad; i < data.size(); i++)
-        if (data[i] != pad) return false;
+    size_t pad = pkcs7PadLength(data.data(), data.size());
+    if (!pad) return false;
     data.resize(data.size() - pad);
     return true;
 }
@@ -318,6 +538,26 @@ inline void secure_memzero(void* ptr, size_t len) {
     _ReadWriteBarrier();
 #endif
 }
+// Hardware threads available to parallelFor
+inline size_t workerCount() {
+    return max(1u, thread::hardware_concurrency());
+}
+// Files being processed at once (WorkStealingPool); parallelFor splits the
+// cores between them, so a lone huge file still gets every core
+inline atomic<size_t>& concurrentJobs() {
+    static atomic<size_t> jobs(0);
+    return jobs;
+}
+// Run fn(i) once for every i in [0, n) across the hardware threads
+inline void parallelFor(size_t n, const function<void(size_t)>& fn) {
+    size_t workers = min(max((size_t)1, workerCount() / max((size_t)1, concurrentJobs().load())), n);
+    if (workers <= 1) { for (size_t i = 0; i < n; i++) fn(i); return; }
+    atomic<size_t> next(0);
+    vector<thread> pool;
+    for (size_t w = 0; w < workers; w++)
+        pool.emplace_back([&] { for (size_t i; (i = next++) < n; ) fn(i); });
+    for (auto& t : pool) t.join();
+}
 // Constant-time comparison to prevent timing attacks
 inline bool constant_time_compare(const unsigned char* a, const unsigned char* b, size_t len) {
     unsigned char diff = 0;
@@ -351,6 +591,8 @@ public:
     void update(const unsigned char* data, size_t len) {
         inner.update(data, len);
     }
+    // Lets callers advance the MAC alongside other streams (SHA256Impl::updateMany)
+    SHA256Impl::Hasher& innerHasher() { return inner; }
     vector<unsigned char> final() {
         auto ih = inner.final();
         outer.update(ih.data(), ih.size());
@@ -358,43 +600,221 @@ public:
     }
 };
 
-// HMAC-SHA256 high-level utility
-inline vector<unsigned char> hmac_sha256(const unsigned char* key, size_t keyLen, 
-                                   const unsigned char* data, size_t dataLen) {
-    HMAC_SHA256 ctx(key, keyLen);
-    ctx.update(data, dataLen);
-    return ctx.final();
-}
 // PBKDF2-SHA256 key derivation
-inline void pbkdf2_sha256(const string& password, const unsigned char* salt, size_t saltLen,
-                   int iterations, unsigned char* output, size_t dkLen) {
-    const size_t HASH_LEN = 32;
-    size_t blocks = (dkLen + HASH_LEN - 1) / HASH_LEN;
-    
-    for (size_t block = 1; block <= blocks; block++) {
+// The HMAC ipad/opad midstates are computed once per password; each
+// iteration is then two fixed-layout compressions on stack buffers, with
+// independent output blocks advanced together (interleaved SHA-NI / SIMD lanes).
+class PBKDF2_SHA256 {
+    typedef SHA256Impl::uint32 uint32;
+    uint32 innerMid[8], outerMid[8];
+    // 32-byte digest + SHA-256 padding for a 96-byte message (64-byte pad block + 32)
+    static void initBlock(unsigned char block[64]) {
+        memset(block, 0, 64);
+        block[32] = 0x80;
+        block[62] = 0x03;   // 768 bits
+    }
+    static void storeDigest(unsigned char* out, const uint32 st[8]) {
+        for (int j = 0; j < 8; j++) {
+            out[j*4] = (unsigned char)(st[j] >> 24); out[j*4+1] = (unsigned char)(st[j] >> 16);
+            out[j*4+2] = (unsigned char)(st[j] >> 8); out[j*4+3] = (unsigned char)st[j];
+        }
+    }
+public:
+    PBKDF2_SHA256() { setPassword(""); }
+    explicit PBKDF2_SHA256(const string& pw) { setPassword(pw); }
+    ~PBKDF2_SHA256() {
+        secure_memzero(innerMid, sizeof(innerMid));
+        secure_memzero(outerMid, sizeof(outerMid));
+    }
+    void setPassword(const string& pw) {
+        unsigned char keyBlock[64] = {0};
+        if (pw.size() > 64) {
+            auto h = SHA256Impl::hash((const unsigned char*)pw.data(), pw.size());
+            memcpy(keyBlock, h.data(), 32);
+        } else {
+            memcpy(keyBlock, pw.data(), pw.size());
+        }
+        unsigned char pad[64];
+        memcpy(innerMid, SHA256Impl::IV, sizeof(innerMid));
+        memcpy(outerMid, SHA256Impl::IV, sizeof(outerMid));
+        for (int i = 0; i < 64; i++) pad[i] = keyBlock[i] ^ 0x36;
+        SHA256Impl::compressBlocks(SHA256Impl::bestBackend(), innerMid, pad, 1);
+        for (int i = 0; i < 64; i++) pad[i] = keyBlock[i] ^ 0x5c;
+        SHA256Impl::compressBlocks(SHA256Impl::bestBackend(), outerMid, pad, 1);
+        secure_memzero(keyBlock, 64);
+        secure_memzero(pad, 64);
+    }
+private:
+    // One PBKDF2 output block = one chain: U (padded block) and running XOR T
+    struct Chain {
+        unsigned char u[64];
+        uint32 T[8];
+    };
+    void startChain(Chain& c, const unsigned char* salt, size_t saltLen, uint32 blockIndex) const {
         // U1 = HMAC(password, salt || INT(block))
-        vector<unsigned char> saltBlock(salt, salt + saltLen);
-        saltBlock.push_back((block >> 24) & 0xFF);
-        saltBlock.push_back((block >> 16) & 0xFF);
-        saltBlock.push_back((block >> 8) & 0xFF);
-        saltBlock.push_back(block & 0xFF);
-        
-        auto U = hmac_sha256((unsigned char*)password.data(), password.size(),
-                             saltBlock.data(), saltBlock.size());
-        vector<unsigned char> T = U;
-        
-        // Iterate: T = U1 ^ U2 ^ ... ^ Uc
-        for (int i = 1; i < iterations; i++) {
-            U = hmac_sha256((unsigned char*)password.data(), password.size(),
-                           U.data(), U.size());
-            for (size_t j = 0; j < HASH_LEN; j++) T[j] ^= U[j];
+        unsigned char be[4] = {(unsigned char)(blockIndex >> 24), (unsigned char)(blockIndex >> 16),
+                               (unsigned char)(blockIndex >> 8), (unsigned char)blockIndex};
+        SHA256Impl::Hasher inner(innerMid, 1), outer(outerMid, 1);
+        inner.update(salt, saltLen);
+        inner.update(be, 4);
+        auto ih = inner.final();
+        outer.update(ih.data(), ih.size());
+        auto u1 = outer.final();
+        initBlock(c.u);
+        memcpy(c.u, u1.data(), 32);
+        for (int j = 0; j < 8; j++)
+            c.T[j] = ((uint32)u1[j*4]<<24)|((uint32)u1[j*4+1]<<16)|((uint32)u1[j*4+2]<<8)|u1[j*4+3];
+        secure_memzero(u1.data(), u1.size());
+    }
+    // Iterate: T = U1 ^ U2 ^ ... ^ Uc, up to 8 chains side by side
+    void runChains(Chain* chains, size_t n, int iterations) const {
+        const size_t GROUP = 8;
+        for (size_t base = 0; base < n; base += GROUP) {
+            size_t g = min(GROUP, n - base);
+            uint32 st[GROUP][8];
+            unsigned char h[GROUP][64];
+            uint32* stp[GROUP];
+            const unsigned char* up[GROUP];
+            const unsigned char* hp[GROUP];
+            for (size_t k = 0; k < g; k++) {
+                initBlock(h[k]);
+                stp[k] = st[k]; up[k] = chains[base + k].u; hp[k] = h[k];
+            }
+            for (int i = 1; i < iterations; i++) {
+                for (size_t k = 0; k < g; k++) memcpy(st[k], innerMid, 32);
+                SHA256Impl::compressMany(stp, up, g);
+                for (size_t k = 0; k < g; k++) { storeDigest(h[k], st[k]); memcpy(st[k], outerMid, 32); }
+                SHA256Impl::compressMany(stp, hp, g);
+                for (size_t k = 0; k < g; k++) {
+                    Chain& c = chains[base + k];
+                    storeDigest(c.u, st[k]);
+                    for (int j = 0; j < 8; j++) c.T[j] ^= st[k][j];
+                }
+            }
+            secure_memzero(st, sizeof(st)); secure_memzero(h, sizeof(h));
         }
-        
-        // Copy result block
-        size_t offset = (block - 1) * HASH_LEN;
-        size_t copyLen = min(HASH_LEN, dkLen - offset);
-        memcpy(output + offset, T.data(), copyLen);
     }
+    static void finishChains(const Chain* chains, size_t n, unsigned char* output, size_t dkLen) {
+        for (size_t k = 0; k < n; k++) {
+            unsigned char tb[32];
+            storeDigest(tb, chains[k].T);
+            size_t offset = k * 32;
+            memcpy(output + offset, tb, min((size_t)32, dkLen - offset));
+            secure_memzero(tb, 32);
+        }
+    }
+public:
+    void derive(const unsigned char* salt, size_t saltLen, int iterations,
+                unsigned char* output, size_t dkLen) const {
+        size_t blocks = (dkLen + 31) / 32;
+        vector<Chain> chains(blocks);
+        for (size_t k = 0; k < blocks; k++) startChain(chains[k], salt, saltLen, (uint32)(k + 1));
+        runChains(chains.data(), blocks, iterations);
+        finishChains(chains.data(), blocks, output, dkLen);
+        secure_memzero(chains.data(), chains.size() * sizeof(Chain));
+    }
+    // Same password, many salts (one per file): every output block of every
+    // salt is an independent chain, packed into lanes and spread over cores
+    void deriveBatch(const vector<const unsigned char*>& salts, size_t saltLen, int iterations,
+                     const vector<unsigned char*>& outputs, size_t dkLen) const {
+        size_t blocks = (dkLen + 31) / 32;
+        size_t total = salts.size() * blocks;
+        if (total == 0) return;
+        vector<Chain> chains(total);
+        for (size_t i = 0; i < salts.size(); i++)
+            for (size_t k = 0; k < blocks; k++)
+                startChain(chains[i*blocks + k], salts[i], saltLen, (uint32)(k + 1));
+        const size_t GROUP = 8;
+        size_t groups = (total + GROUP - 1) / GROUP;
+        size_t workers = min((size_t)max(1u, thread::hardware_concurrency()), groups);
+        vector<thread> pool;
+        for (size_t w = 0; w < workers; w++) {
+            size_t first = groups * w / workers * GROUP;
+            size_t last = min(total, groups * (w + 1) / workers * GROUP);
+            pool.emplace_back([this, &chains, first, last, iterations] {
+                runChains(chains.data() + first, last - first, iterations);
+            });
+        }
+        for (auto& t : pool) t.join();
+        for (size_t i = 0; i < salts.size(); i++)
+            finishChains(chains.data() + i*blocks, blocks, outputs[i], dkLen);
+        secure_memzero(chains.data(), chains.size() * sizeof(Chain));
+    }
+};
+// ═══════════════════════════════════════════════════════════
+// AES-256-GCM (NIST SP 800-38D): 96-bit nonces, 128-bit tags
+// ═══════════════════════════════════════════════════════════
+class AES256GCM {
+    AES256Impl::Context aes;
+    unsigned char H[16];
+    static void counterBlock(const unsigned char nonce[12], unsigned int counter, unsigned char out[16]) {
+        memcpy(out, nonce, 12);
+        out[12] = (unsigned char)(counter >> 24); out[13] = (unsigned char)(counter >> 16);
+        out[14] = (unsigned char)(counter >> 8);  out[15] = (unsigned char)counter;
+    }
+public:
+    static const int NONCE_SIZE = 12;
+    static const int TAG_SIZE = 16;
+    AES256GCM() { memset(H, 0, 16); }
+    ~AES256GCM() { secure_memzero(H, 16); }
+    void setKey(const unsigned char key[32]) {
+        aes.keyExpansion(key);
+        memset(H, 0, 16);
+        aes.encryptBlocks(H, 1);   // H = E_K(0^128)
+    }
+    const unsigned char* hashKey() const { return H; }
+    // CTR keystream starting at inc32(J0); J0 = nonce || 1
+    void crypt(const unsigned char nonce[12], unsigned char* data, size_t len) {
+        unsigned char ks[512];
+        unsigned int counter = 2;
+        for (size_t off = 0; off < len; off += sizeof(ks)) {
+            size_t n = min(sizeof(ks), len - off), blocks = (n + 15) / 16;
+            for (size_t b = 0; b < blocks; b++) counterBlock(nonce, counter++, ks + b*16);
+            aes.encryptBlocks(ks, blocks);
+            for (size_t i = 0; i < n; i++) data[off + i] ^= ks[i];
+        }
+        secure_memzero(ks, sizeof(ks));
+    }
+    // Tag = E_K(J0) ^ GHASH(A, C)
+    void finishTag(const unsigned char nonce[12], GHASHImpl::Hasher& gh,
+                   unsigned long long aadLen, unsigned long long ctLen, unsigned char tag[16]) {
+        unsigned char s[16], j0[16];
+        gh.final(aadLen, ctLen, s);
+        counterBlock(nonce, 1, j0);
+        aes.encryptBlocks(j0, 1);
+        for (int i = 0; i < 16; i++) tag[i] = s[i] ^ j0[i];
+    }
+    void seal(const unsigned char nonce[12], const unsigned char* aad, size_t aadLen,
+              unsigned char* data, size_t len, unsigned char tag[16]) {
+        crypt(nonce, data, len);
+        GHASHImpl::Hasher gh(H);
+        gh.update(aad, aadLen); gh.pad();
+        gh.update(data, len);
+        finishTag(nonce, gh, aadLen, len, tag);
+    }
+    // Verifies before decrypting; data is left untouched on failure
+    bool open(const unsigned char nonce[12], const unsigned char* aad, size_t aadLen,
+              unsigned char* data, size_t len, const unsigned char tag[16]) {
+        unsigned char expected[16];
+        GHASHImpl::Hasher gh(H);
+        gh.update(aad, aadLen); gh.pad();
+        gh.update(data, len);
+        finishTag(nonce, gh, aadLen, len, expected);
+        if (!constant_time_compare(expected, tag, 16)) return false;
+        crypt(nonce, data, len);
+        return true;
+    }
+};
+#include "crypto_provider.h"
+// One-shot helpers, dispatched to the selected provider; false if it failed
+inline bool hmac_sha256(const unsigned char* key, size_t keyLen,
+                        const unsigned char* data, size_t dataLen, unsigned char mac[32]) {
+    return CryptoProvider::hmacSha256(key, keyLen, data, dataLen, mac);
+}
+inline bool pbkdf2_sha256(const string& password, const unsigned char* salt, size_t saltLen,
+                   int iterations, unsigned char* output, size_t dkLen) {
+    return iterations > 0
+        && CryptoProvider::pbkdf2Sha256(password, salt, saltLen, (unsigned int)iterations, output, dkLen);
 }
 // ═══════════════════════════════════════════════════════════
 // Progress Bar
@@ -403,14 +823,15 @@ inline void pbkdf2_sha256(const string& password, const unsigned char* salt, siz
 class ProgressBar {
     size_t total, current;
     int barWidth;
+    bool visible;
     chrono::steady_clock::time_point startTime;
 public:
-    ProgressBar(size_t t, int w = 40) : total(t), current(0), barWidth(w) {
+    ProgressBar(size_t t, int w = 40, bool show = true) : total(t), current(0), barWidth(w), visible(show) {
         startTime = chrono::steady_clock::now();
     }
     void update(size_t bytes) {
         current += bytes;
-        if (total == 0) return;
+        if (total == 0 || !visible) return;
         double frac = (double)current / total;
         int filled = (int)(frac * barWidth);
         auto now = chrono::steady_clock::now();
@@ -423,6 +844,7 @@ public:
              << fixed << setprecision(1) << speed << " MB/s | ETA " << (int)eta << "s" << flush;
     }
     void finish() {
+        if (!visible) return;
         auto now = chrono::steady_clock::now();
         double elapsed = chrono::duration<double>(now - startTime).count();
         double speed = elapsed > 0 ? (total / 1048576.0) / elapsed : 0;
@@ -583,38 +1005,750 @@ public:
     }
 };
 
+#include "async_io.h"
+
+// ═══════════════════════════════════════════════════════════
+// Memory-Mapped Files (POSIX)
+// Inputs are mapped read-only with sequential readahead hints;
+// outputs are preallocated to their final size before mapping,
+// so running out of space fails here instead of as SIGBUS on a
+// page write (and the extent is laid out contiguously). Every
+// call returns false on Windows or unsupported filesystems;
+// callers then use the stream path.
+// ═══════════════════════════════════════════════════════════
+class MappedFile {
+    unsigned char* base = nullptr;
+    size_t length = 0;
+#ifndef _WIN32
+    int fd = -1;
+#endif
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+    unsigned char* data() { return base; }
+    size_t size() const { return length; }
+
+    bool openRead(const string& path) {
+#ifndef _WIN32
+        close();
+        fd = ::open(path.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0) { close(); return false; }
+        length = (size_t)st.st_size;
+        if (length == 0) return true;
+        void* p = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) { close(); return false; }
+        base = (unsigned char*)p;
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        madvise(base, length, MADV_SEQUENTIAL);
+        return true;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+    bool create(const string& path, size_t size) {
+#ifndef _WIN32
+        close();
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+        if (fd < 0) return false;
+        length = size;
+        if (size == 0) return true;
+#if defined(__linux__)
+        bool reserved = fallocate(fd, 0, 0, (off_t)size) == 0;
+#else
+        bool reserved = posix_fallocate(fd, 0, (off_t)size) == 0;
+#endif
+        if (!reserved) { close(); return false; }
+        void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) { close(); return false; }
+        base = (unsigned char*)p;
+        madvise(base, length, MADV_SEQUENTIAL);
+        return true;
+#else
+        (void)path; (void)size;
+        return false;
+#endif
+    }
+    // Ask the kernel to start reading [offset, offset + len) ahead of use
+    void willNeed(size_t offset, size_t len) {
+#ifndef _WIN32
+        if (fd >= 0 && offset < length) posix_fadvise(fd, (off_t)offset, (off_t)min(len, length - offset), POSIX_FADV_WILLNEED);
+#else
+        (void)offset; (void)len;
+#endif
+    }
+    void close() {
+#ifndef _WIN32
+        if (base) munmap(base, length);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        base = nullptr;
+        length = 0;
+    }
+};
+
+// Force a file's written data to stable storage
+inline bool syncFile(const string& path) {
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#else
+    HANDLE h = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    bool ok = FlushFileBuffers(h) != 0;
+    CloseHandle(h);
+    return ok;
+#endif
+}
+
 // ═══════════════════════════════════════════════════════════
 // AES Cipher Class (PBKDF2 + HMAC-SHA256 Authentication)
 // File format: salt(16) + iv(16) + ciphertext + hmac(32)
+// File v3: "CVPF" + 0x03 + suite + salt + iv + kcv(16) + chunkSize(4) + plainLen(8)
+//          + headerTag(32) + ptHash, then per chunk: ciphertext + tag
+// File v4: v3 with 0x04, the session master salt and KDF parameters(10) after
+//          plainLen, then a wrapped data key(80): password -> master key (once)
+//          -> per-file data key
+//   ctr-hmac: AES-CTR, HMAC-SHA256 tags (32)   gcm: AES-GCM tags (16), GMAC header
+//   chacha20-poly1305: RFC 8439 tags (16), Poly1305 header
 // ═══════════════════════════════════════════════════════════
 class AESCipher {
+public:
+    // v3 cipher suites, recorded in the header
+    enum class Suite : unsigned char { CtrHmac = 0x01, Gcm = 0x02, ChaCha = 0x03 };
+    static const char* suiteName(Suite s) {
+        switch (s) {
+            case Suite::Gcm:    return "gcm";
+            case Suite::ChaCha: return "chacha20-poly1305";
+            default:            return "ctr-hmac";
+        }
+    }
+    static bool parseSuite(const string& name, Suite& out) {
+        if (name == "gcm" || name == "aes-gcm") { out = Suite::Gcm; return true; }
+        if (name == "chacha20-poly1305" || name == "chacha") { out = Suite::ChaCha; return true; }
+        if (name == "ctr-hmac" || name == "hmac") { out = Suite::CtrHmac; return true; }
+        return false;
+    }
+    // v4 password KDF, recorded in the header: id(1) | passes(4) | memoryKiB(4) | lanes(1)
+    enum class Kdf : unsigned char { Pbkdf2 = 0x01, Argon2id = 0x02 };
+    // Largest Argon2id cost accepted from a header or config; calibrateKdf stays within it
+    static constexpr unsigned int ARGON2_MAX_PASSES = 16, ARGON2_MAX_MEMORY_KIB = 1u << 20, ARGON2_MAX_LANES = 4;
+    struct KdfParams {
+        Kdf kdf = Kdf::Pbkdf2;
+        unsigned int passes = PBKDF2_ITERATIONS;   // PBKDF2 iterations, or Argon2 passes
+        unsigned int memoryKiB = 0;     // Argon2 only
+        unsigned int lanes = 0;         // Argon2 only
+    };
+    // Outcome of encryptFile/decryptFile: what the pass already knows about
+    // the plaintext, so audit and logging need not read the file again
+    struct FileResult {
+        bool ok = false;
+        vector<unsigned char> ptHash;           // plaintext SHA-256; empty if not computed (see setHashPlaintext)
+        unsigned long long plainSize = 0, cipherSize = 0;
+        double keyMs = 0, bodyMs = 0, totalMs = 0;   // key derivation/unwrap, chunk pass, whole call
+        explicit operator bool() const { return ok; }
+        string hashHex() const { return ptHash.empty() ? "" : SHA256Impl::toHex(ptHash); }
+    };
+    static bool parseKdf(const string& name, Kdf& out) {
+        if (name == "pbkdf2" || name == "pbkdf2-sha256") { out = Kdf::Pbkdf2; return true; }
+        if (name == "argon2id" || name == "argon2") { out = Kdf::Argon2id; return true; }
+        return false;
+    }
+    static string kdfName(const KdfParams& p) {
+        if (p.kdf == Kdf::Argon2id)
+            return "argon2id (t=" + to_string(p.passes) + ", m=" + to_string(p.memoryKiB / 1024)
+                   + " MiB, p=" + to_string(p.lanes) + ")";
+        return "pbkdf2-sha256 (" + to_string(p.passes) + " iterations)";
+    }
+    // Bounds for header-supplied parameters: a forged header must not be able
+    // to demand hours of CPU or gigabytes of memory before the key check fails
+    static bool kdfSane(const KdfParams& p) {
+        if (p.kdf == Kdf::Pbkdf2) return p.passes >= 1000 && p.passes <= 50000000 && !p.memoryKiB && !p.lanes;
+        if (p.kdf == Kdf::Argon2id)
+            return p.passes >= 1 && p.passes <= ARGON2_MAX_PASSES && p.lanes >= 1 && p.lanes <= ARGON2_MAX_LANES
+                && p.memoryKiB >= Argon2Impl::minMemoryKiB(p.lanes) && p.memoryKiB <= ARGON2_MAX_MEMORY_KIB;
+        return false;
+    }
+    // Pick parameters that take about targetMs on this host. Argon2id grows
+    // memory first (up to 1 GiB, 3 passes, up to 4 lanes), then passes (up to 16).
+    // `measuredMs` receives the time of one derivation with the result.
+    static KdfParams calibrateKdf(Kdf kdf, double targetMs, double& measuredMs) {
+        const unsigned char salt[16] = {0};
+        unsigned char out[64];
+        auto timeMs = [&](const KdfParams& p) {
+            auto t0 = chrono::steady_clock::now();
+            if (p.kdf == Kdf::Argon2id)
+                Argon2Impl::argon2id((const unsigned char*)"calibrate", 9, salt, 16, p.passes, p.memoryKiB, p.lanes, out, 64);
+            else
+                (void)CryptoProvider::pbkdf2Sha256("calibrate", salt, 16, p.passes, out, 64);
+            return max(0.001, chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count());
+        };
+        KdfParams p;
+        p.kdf = kdf;
+        if (kdf == Kdf::Pbkdf2) {
+            p.passes = 20000;
+            timeMs(p);   // warm-up: backend selection, page faults
+            double ms = timeMs(p);
+            p.passes = (unsigned int)min(50000000.0, max(10000.0, round(p.passes * targetMs / ms / 1000) * 1000));
+            measuredMs = timeMs(p);
+            return p;
+        }
+        const unsigned int maxKiB = ARGON2_MAX_MEMORY_KIB;
+        p.passes = 3;
+        p.lanes = max(1u, min(ARGON2_MAX_LANES, thread::hardware_concurrency()));
+        p.memoryKiB = 8192;
+        double ms = timeMs(p);
+        while (ms * 2 < targetMs && p.memoryKiB * 2 <= maxKiB) { p.memoryKiB *= 2; ms = timeMs(p); }
+        if (ms < targetMs && p.memoryKiB * 2 > maxKiB)
+            p.passes = (unsigned int)min((double)ARGON2_MAX_PASSES, max(3.0, p.passes * targetMs / ms));
+        else if (ms < targetMs) {
+            // Fill the gap linearly, in whole MiB per lane
+            unsigned int step = 1024 * p.lanes;
+            p.memoryKiB = min(maxKiB, (unsigned int)(p.memoryKiB * targetMs / ms) / step * step);
+        }
+        measuredMs = timeMs(p);
+        secure_memzero(out, sizeof(out));
+        return p;
+    }
 private:
     string storedPassword;
+    PBKDF2_SHA256 kdf;   // password midstates, reused for every salt
     unsigned char encKey[32];
     unsigned char authKey[32];
     AES256Impl::Context ctx;
+    AES256GCM gcm;
+    ChaCha20Poly1305 chacha;
+    Suite suite = Suite::CtrHmac;   // suite for newly encrypted files
+public:
+    // File I/O for v3/v4 bodies: Auto maps files of MMAP_THRESHOLD and up,
+    // smaller ones stream through the AsyncIO pipeline
+    enum class IoMode { Auto, Stream, Mapped };
+private:
+    IoMode ioMode = IoMode::Auto;
+    AsyncIO::Engine ioEngine = AsyncIO::Engine::Auto;
+    bool quiet = false;             // no progress bars (parallel directory workers)
+    bool hashPlaintext = false;     // SHA-256 the plaintext for every suite, not just ctr-hmac
+    KdfParams kdfParams;            // KDF for new v4 master keys
     
     static const int SALT_SIZE = 16;
     static const int IV_SIZE = 16;
     static const int HMAC_SIZE = 32;
-    static const int PBKDF2_ITERATIONS = 100000;
-    // Derive encryption and authentication keys from password + salt
-    void deriveKeys(const unsigned char* salt) {
+    static const int KCV_SIZE = 16;
+    static const int CHUNK_SIZE = 1 << 20;   // v3 plaintext bytes per chunk
+    static const int V3_PREFIX_SIZE = 4 + 1 + 1 + SALT_SIZE + IV_SIZE + KCV_SIZE + 4 + 8;
+    static const int V3_HEADER_SIZE = V3_PREFIX_SIZE + HMAC_SIZE + 32;
+    static const int KDF_PARAMS_SIZE = 10;
+    static const int V4_PREFIX_SIZE = V3_PREFIX_SIZE + KDF_PARAMS_SIZE;
+    static const int DATA_KEY_SIZE = 64;   // encKey + authKey
+    static const int WRAP_SIZE = DATA_KEY_SIZE + AES256GCM::TAG_SIZE;
+    static const int PBKDF2_ITERATIONS = 100000;   // v1-v3 and in-memory blobs; v4 records its own
+    // Derived keys, shared with forkWorker() copies so that workers pick up
+    // each other's derivations instead of repeating them
+    struct KeyStore {
+        mutex m;
+        condition_variable published;   // a pending master key became ready or was dropped
+        // Keys derived ahead of time by prefetchKeys(), keyed by salt; consumed on use
+        map<string, array<unsigned char, 64>> fileKeys;
+        // v4 master keys (key-wrap key + KCV key), keyed by salt || KDF parameters;
+        // kept for the session. Not ready yet: some fork is deriving it.
+        struct Master {
+            array<unsigned char, 64> key = {};
+            bool ready = false;
+        };
+        map<string, Master> masters;
+        ~KeyStore() {
+            for (auto& kv : fileKeys) secure_memzero(kv.second.data(), 64);
+            for (auto& kv : masters) secure_memzero(kv.second.key.data(), 64);
+        }
+    };
+    shared_ptr<KeyStore> keyStore = make_shared<KeyStore>();
+    // Forks keep the old store alive (and wipe it) until they are gone
+    void clearKeyCache() {
+        keyStore = make_shared<KeyStore>();
+        sessionSalt.clear();
+    }
+    string sessionSalt;   // master salt for files written by this session
+    static void putKdfParams(unsigned char* p, const KdfParams& k) {
+        p[0] = (unsigned char)k.kdf;
+        putBE(p + 1, k.passes, 4);
+        putBE(p + 5, k.memoryKiB, 4);
+        p[9] = (unsigned char)k.lanes;
+    }
+    static KdfParams getKdfParams(const unsigned char* p) {
+        KdfParams k;
+        k.kdf = (Kdf)p[0];
+        k.passes = (unsigned int)getBE(p + 1, 4);
+        k.memoryKiB = (unsigned int)getBE(p + 5, 4);
+        k.lanes = p[9];
+        return k;
+    }
+    static string masterCacheKey(const unsigned char* salt, const KdfParams& k) {
+        unsigned char p[KDF_PARAMS_SIZE];
+        putKdfParams(p, k);
+        return string((const char*)salt, SALT_SIZE) + string((const char*)p, KDF_PARAMS_SIZE);
+    }
+    // Salt location for v3/v4 ("CVPF" + ver + suite + salt), v2 ("CVPF" + ver + salt)
+    // and headerless v1 (salt first); v4 KDF parameters follow the v3 prefix
+    static bool readSalt(const string& file, unsigned char salt[SALT_SIZE], char& version, KdfParams& params) {
+        ifstream in(file, ios::binary);
+        char magic[5] = {0};
+        if (!in.read(magic, 5)) return false;
+        version = strncmp(magic, "CVPF", 4) == 0 ? magic[4] : 0x01;
+        if (version == 0x01) in.seekg(0, ios::beg);
+        else if (version >= 0x03) in.seekg(6, ios::beg);
+        if (!in.read((char*)salt, SALT_SIZE)) return false;
+        if (version == 0x04) {
+            unsigned char p[KDF_PARAMS_SIZE];
+            in.seekg(V3_PREFIX_SIZE, ios::beg);
+            if (!in.read((char*)p, KDF_PARAMS_SIZE)) return false;
+            params = getKdfParams(p);
+        }
+        return true;
+    }
+    // Batch-derive one 64-byte PBKDF2 key per entry; each entry starts with its salt
+    vector<array<unsigned char, 64>> deriveSalts(const vector<string>& keys, unsigned int iterations) {
+        vector<array<unsigned char, 64>> derived(keys.size());
+        if (keys.empty()) return derived;
+        vector<const unsigned char*> in;
+        vector<unsigned char*> out;
+        for (size_t i = 0; i < keys.size(); i++) {
+            in.push_back((const unsigned char*)keys[i].data());
+            out.push_back(derived[i].data());
+        }
+        kdf.deriveBatch(in, SALT_SIZE, iterations, out, 64);
+        return derived;
+    }
+    // Derive encryption and authentication keys from password + salt; false if the KDF failed
+    bool deriveKeys(const unsigned char* salt) {
         unsigned char derived[64];
-        pbkdf2_sha256(storedPassword, salt, SALT_SIZE, PBKDF2_ITERATIONS, derived, 64);
-        memcpy(encKey, derived, 32);      // First 32 bytes for encryption
-        memcpy(authKey, derived + 32, 32); // Last 32 bytes for authentication
+        bool found = false;
+        {
+            lock_guard<mutex> g(keyStore->m);
+            auto cached = keyStore->fileKeys.find(string((const char*)salt, SALT_SIZE));
+            if (cached != keyStore->fileKeys.end()) {
+                memcpy(derived, cached->second.data(), 64);
+                secure_memzero(cached->second.data(), 64);
+                keyStore->fileKeys.erase(cached);
+                found = true;
+            }
+        }
+        if (!found && !CryptoProvider::pbkdf2Sha256(storedPassword, salt, SALT_SIZE, PBKDF2_ITERATIONS, derived, 64)) {
+            cerr << "\n❌ Error: Key derivation failed (pbkdf2-sha256)" << endl;
+            return false;
+        }
+        useKeys(derived);
         secure_memzero(derived, 64);
+        return true;
+    }
+    // Install a 64-byte key set: first 32 bytes for encryption, last 32 for authentication
+    void useKeys(const unsigned char keys[64]) {
+        memcpy(encKey, keys, 32);
+        memcpy(authKey, keys + 32, 32);
         ctx.keyExpansion(encKey);
+        gcm.setKey(encKey);
+        chacha.setKey(encKey);
+    }
+    // One master key derivation; false if the KDF failed
+    bool deriveMaster(const unsigned char* salt, const KdfParams& params, unsigned char out[64]) {
+        if (params.kdf != Kdf::Argon2id)
+            return CryptoProvider::pbkdf2Sha256(storedPassword, salt, SALT_SIZE, params.passes, out, 64);
+        try {
+            return Argon2Impl::argon2id((const unsigned char*)storedPassword.data(), storedPassword.size(),
+                                        salt, SALT_SIZE, params.passes, params.memoryKiB, params.lanes, out, 64);
+        } catch (const bad_alloc&) {
+            return false;   // memory cost within kdfSane but more than this host has free
+        }
+    }
+    // v4 master key for `salt`: derived on first use, then reused by every file sharing it.
+    // The store lock only covers the lookup: the fork that claims a missing entry derives
+    // it unlocked, forks needing the same key wait for it, other keys stay available.
+    // Ready entries are never erased, the pointer stays valid while the store lives.
+    // nullptr if the KDF failed; nothing is cached then.
+    const unsigned char* masterKey(const unsigned char* salt, const KdfParams& params) {
+        string k = masterCacheKey(salt, params);
+        KeyStore& store = *keyStore;
+        unique_lock<mutex> g(store.m);
+        for (auto it = store.masters.find(k); it != store.masters.end(); it = store.masters.find(k)) {
+            if (it->second.ready) return it->second.key.data();
+            store.published.wait(g);
+        }
+        store.masters[k];   // claimed
+        g.unlock();
+        unsigned char key[64];
+        bool ok = deriveMaster(salt, params, key);
+        g.lock();
+        auto it = store.masters.find(k);
+        if (ok) {
+            memcpy(it->second.key.data(), key, 64);
+            it->second.ready = true;
+        } else {
+            store.masters.erase(it);
+        }
+        secure_memzero(key, 64);
+        store.published.notify_all();
+        if (!ok) {
+            cerr << "\n❌ Error: Key derivation failed (" << kdfName(params) << ")" << endl;
+            return nullptr;
+        }
+        return it->second.key.data();
+    }
+    // Master salt for new v4 files, chosen once per session (password)
+    bool sessionMasterSalt(unsigned char salt[SALT_SIZE]) {
+        if (sessionSalt.empty()) {
+            if (!generateRandomBytes(salt, SALT_SIZE)) return false;
+            sessionSalt.assign((const char*)salt, SALT_SIZE);
+        }
+        memcpy(salt, sessionSalt.data(), SALT_SIZE);
+        return true;
+    }
+    // Data key wrap: AES-256-GCM under the master key, nonce from the file IV,
+    // the v4 prefix as AAD. `wrap` holds the 64-byte key on input, key || tag on output.
+    // On failure `wrap` is wiped.
+    static bool wrapDataKey(const unsigned char* master, const unsigned char* prefix,
+                            unsigned char wrap[WRAP_SIZE]) {
+        if (CryptoProvider::gcmSeal(master, prefix + 6 + SALT_SIZE, prefix, V4_PREFIX_SIZE, wrap, DATA_KEY_SIZE,
+                                    wrap + DATA_KEY_SIZE))
+            return true;
+        secure_memzero(wrap, WRAP_SIZE);
+        cerr << "\n❌ Error: Data key wrap failed" << endl;
+        return false;
+    }
+    static bool unwrapDataKey(const unsigned char* master, const unsigned char* prefix,
+                              const unsigned char wrap[WRAP_SIZE], unsigned char dataKey[DATA_KEY_SIZE]) {
+        memcpy(dataKey, wrap, DATA_KEY_SIZE);
+        if (CryptoProvider::gcmOpen(master, prefix + 6 + SALT_SIZE, prefix, V4_PREFIX_SIZE, dataKey, DATA_KEY_SIZE,
+                                    wrap + DATA_KEY_SIZE))
+            return true;
+        secure_memzero(dataKey, DATA_KEY_SIZE);
+        return false;
     }
     // Compute HMAC over salt + iv + ciphertext
-    vector<unsigned char> computeHMAC(const unsigned char* data, size_t len) {
-        return hmac_sha256(authKey, 32, data, len);
+    bool computeHMAC(const unsigned char* data, size_t len, unsigned char out[HMAC_SIZE]) {
+        return hmac_sha256(authKey, 32, data, len, out);
+    }
+    // Key-check value: truncated HMAC over the header under a password-derived
+    // key (authKey in v3, the master KCV key in v4), lets a wrong password be
+    // rejected right after the KDF without reading the body
+    static void computeKeyCheck(const unsigned char* key, char version, const unsigned char* salt,
+                                const unsigned char* iv, unsigned char out[KCV_SIZE]) {
+        HMAC_SHA256 h(key, 32);
+        h.update((const unsigned char*)"CVPF-KCV", 8);
+        h.update((const unsigned char*)&version, 1);
+        h.update(salt, SALT_SIZE);
+        h.update(iv, IV_SIZE);
+        auto tag = h.final();
+        memcpy(out, tag.data(), KCV_SIZE);
+    }
+    static void putBE(unsigned char* p, unsigned long long v, int bytes) {
+        for (int i = bytes - 1; i >= 0; i--) { p[i] = (unsigned char)v; v >>= 8; }
+    }
+    static unsigned long long getBE(const unsigned char* p, int bytes) {
+        unsigned long long v = 0;
+        for (int i = 0; i < bytes; i++) v = (v << 8) | p[i];
+        return v;
+    }
+    static unsigned long long chunkCount(unsigned long long plainLen, unsigned long long chunkSize) {
+        return plainLen == 0 ? 1 : (plainLen + chunkSize - 1) / chunkSize;
+    }
+    // AES-CTR from block number `start`: counter = iv + start (128-bit big-endian),
+    // so every v3 chunk's keystream can be produced independently
+    void ctrXor(const unsigned char iv[16], unsigned long long start, unsigned char* data, size_t len) {
+        unsigned char ctr[16], ks[512];
+        memcpy(ctr, iv, 16);
+        unsigned carry = 0;
+        for (int i = 15; i >= 0; i--) {
+            unsigned sum = ctr[i] + (unsigned)(start & 0xff) + carry;
+            ctr[i] = (unsigned char)sum; carry = sum >> 8; start >>= 8;
+        }
+        for (size_t off = 0; off < len; off += sizeof(ks)) {
+            size_t n = min(sizeof(ks), len - off), blocks = (n + 15) / 16;
+            for (size_t b = 0; b < blocks; b++) {
+                memcpy(ks + b*16, ctr, 16);
+                for (int i = 15; i >= 0 && ++ctr[i] == 0; i--) {}
+            }
+            ctx.encryptBlocks(ks, blocks);
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                uint64_t d, k;
+                memcpy(&d, data + off + i, 8); memcpy(&k, ks + i, 8);
+                d ^= k;
+                memcpy(data + off + i, &d, 8);
+            }
+            for (; i < n; i++) data[off + i] ^= ks[i];
+        }
+        secure_memzero(ks, sizeof(ks));
+        secure_memzero(ctr, sizeof(ctr));
+    }
+    // CBC decryption is parallel: each plaintext block needs only its own and the
+    // previous ciphertext block, so slices are decrypted on separate workers.
+    // Chaining blocks are captured up front, so ct may alias pt.
+    static const size_t CBC_SLICE = 256 * 1024;
+    void cbcDecrypt(const unsigned char* ct, unsigned char* pt, size_t len, const unsigned char prev[16]) {
+        size_t slices = (len + CBC_SLICE - 1) / CBC_SLICE;
+        vector<unsigned char> chains(slices * 16);
+        for (size_t k = 0; k < slices; k++)
+            memcpy(chains.data() + k*16, k ? ct + k*CBC_SLICE - 16 : prev, 16);
+        parallelFor(slices, [&](size_t k) {
+            unsigned char chain[16], saved[4096];
+            memcpy(chain, chains.data() + k*16, 16);
+            size_t end = min(len, (k + 1) * CBC_SLICE);
+            for (size_t off = k * CBC_SLICE; off < end; off += sizeof(saved)) {
+                size_t n = min(sizeof(saved), end - off);
+                memcpy(saved, ct + off, n);
+                memcpy(pt + off, saved, n);
+                ctx.decryptBlocks(pt + off, n / 16);
+                for (int j = 0; j < 16; j++) pt[off + j] ^= chain[j];
+                for (size_t i = 16; i < n; i++) pt[off + i] ^= saved[i - 16];
+                memcpy(chain, saved + n - 16, 16);
+            }
+        });
+    }
+    // Files at least this large take the memory-mapped path under IoMode::Auto
+    static const long long MMAP_THRESHOLD = 64LL << 20;
+    // Override Auto with CRYPTVAULT_IO=mmap|stream; uring|threads also pick the stream path
+    bool useMapped(unsigned long long size) const {
+        IoMode mode = ioMode;
+        if (mode == IoMode::Auto) {
+            const char* env = getenv("CRYPTVAULT_IO");
+            string v = env ? env : "";
+            if (v == "mmap") mode = IoMode::Mapped;
+            else if (v == "stream" || v == "uring" || v == "threads") mode = IoMode::Stream;
+        }
+        if (mode == IoMode::Auto) return size >= (unsigned long long)MMAP_THRESHOLD;
+        return mode == IoMode::Mapped;
+    }
+    // Chunks in flight per batch: enough to feed every core, capped at 256 MB
+    static size_t chunkBatch(size_t chunkSize) {
+        return max((size_t)1, min(workerCount() * 2, ((size_t)256 << 20) / chunkSize));
+    }
+    // Per-chunk authenticator: HMAC(authKey, index || ciphertext). The chunk is
+    // MACed and XORed one cache-sized slice at a time, so each slice is read
+    // from memory once: MAC after XOR when sealing, before XOR when opening.
+    static constexpr size_t PIPE_SLICE = 16384;
+    void ctrHmacChunk(const unsigned char iv[16], unsigned long long index, unsigned long long chunkSize,
+                      unsigned char* data, size_t len, unsigned char tag[32], bool open) {
+        unsigned char idx[8];
+        putBE(idx, index, 8);
+        HMAC_SHA256 h(authKey, 32);
+        h.update(idx, 8);
+        for (size_t off = 0; off < len; off += PIPE_SLICE) {
+            size_t n = min(PIPE_SLICE, len - off);
+            if (open) h.update(data + off, n);
+            ctrXor(iv, index * (chunkSize / 16) + off / 16, data + off, n);
+            if (!open) h.update(data + off, n);
+        }
+        auto t = h.final();
+        memcpy(tag, t.data(), 32);
+    }
+    static size_t tagSize(Suite s) { return s == Suite::CtrHmac ? HMAC_SIZE : AES256GCM::TAG_SIZE; }
+    // AEAD nonce of chunk i: first 12 IV bytes with i XORed into the last 8
+    static void chunkNonce(const unsigned char iv[16], unsigned long long index, unsigned char nonce[12]) {
+        memcpy(nonce, iv, 12);
+        for (int i = 11; i >= 4; i--) { nonce[i] ^= (unsigned char)index; index >>= 8; }
+    }
+    // False if the backend failed; the chunk must not be written then
+    bool sealChunk(Suite s, const unsigned char iv[16], unsigned long long index, unsigned long long chunkSize,
+                   unsigned char* data, size_t len, unsigned char* tag) {
+        if (s == Suite::Gcm) {
+            unsigned char nonce[12];
+            chunkNonce(iv, index, nonce);
+            return CryptoProvider::gcmSeal(encKey, nonce, nullptr, 0, data, len, tag);
+        }
+        if (s == Suite::ChaCha) {
+            unsigned char nonce[12];
+            chunkNonce(iv, index, nonce);
+            chacha.seal(nonce, nullptr, 0, data, len, tag);
+            return true;
+        }
+        ctrHmacChunk(iv, index, chunkSize, data, len, tag, false);
+        return true;
+    }
+    bool openChunk(Suite s, const unsigned char iv[16], unsigned long long index, unsigned long long chunkSize,
+                   unsigned char* data, size_t len, const unsigned char* tag) {
+        if (s == Suite::Gcm) {
+            unsigned char nonce[12];
+            chunkNonce(iv, index, nonce);
+            return CryptoProvider::gcmOpen(encKey, nonce, nullptr, 0, data, len, tag);
+        }
+        if (s == Suite::ChaCha) {
+            unsigned char nonce[12];
+            chunkNonce(iv, index, nonce);
+            return chacha.open(nonce, nullptr, 0, data, len, tag);
+        }
+        // On a mismatch the caller wipes the chunk; nothing unverified is written out
+        unsigned char expected[32];
+        ctrHmacChunk(iv, index, chunkSize, data, len, expected, true);
+        return constant_time_compare(expected, tag, 32);
+    }
+    // v3 header tag over prefix || chunk tags || ptHash: HMAC-SHA256 for
+    // ctr-hmac; for the AEAD suites an empty-plaintext seal with the header as
+    // AAD (nonce index 2^64-1, never used by a chunk)
+    class HeaderAuth {
+        Suite suite;
+        HMAC_SHA256 hmac;
+        GHASHImpl::Hasher gh;
+        unique_ptr<ChaChaImpl::Poly1305> poly;
+        AES256GCM& gcm;
+        unsigned char nonce[12];
+        unsigned long long length = 0;
+    public:
+        HeaderAuth(AESCipher& c, Suite s, const unsigned char iv[16])
+            : suite(s), hmac(c.authKey, 32), gh(c.gcm.hashKey()), gcm(c.gcm) {
+            chunkNonce(iv, ~0ULL, nonce);
+            if (suite == Suite::ChaCha) {
+                unsigned char pk[32];
+                c.chacha.polyKey(nonce, pk);
+                poly.reset(new ChaChaImpl::Poly1305(pk));
+                secure_memzero(pk, 32);
+            }
+        }
+        void update(const unsigned char* data, size_t len) {
+            length += len;
+            if (suite == Suite::Gcm) gh.update(data, len);
+            else if (suite == Suite::ChaCha) poly->update(data, len);
+            else hmac.update(data, len);
+        }
+        void final(unsigned char out[32]) {
+            memset(out, 0, 32);
+            if (suite == Suite::Gcm) { gcm.finishTag(nonce, gh, length, 0, out); return; }
+            if (suite == Suite::ChaCha) { ChaCha20Poly1305::finishTag(*poly, length, 0, out); return; }
+            auto h = hmac.final();
+            memcpy(out, h.data(), 32);
+        }
+    };
+    // v3 body: chunks are verified and decrypted in parallel, written in order.
+    // Batches go through the AsyncIO pipeline: one read of chunk||tag runs per
+    // batch, and only verified plaintext is written out.
+    // ptHash is always computed for ctr-hmac; for the AEAD suites only when auditing needs it.
+    bool decryptChunks(int inFd, int outFd, unsigned long long bodyOffset, HeaderAuth& auth, Suite s,
+                       const unsigned char iv[16], unsigned long long chunkSize, unsigned long long plainLen,
+                       vector<unsigned char>& ptHash) {
+        unsigned long long nChunks = chunkCount(plainLen, chunkSize);
+        size_t batch = (size_t)min((unsigned long long)chunkBatch((size_t)chunkSize), nChunks);
+        size_t tagLen = tagSize(s), stride = (size_t)chunkSize + tagLen;
+        bool wantPtHash = s == Suite::CtrHmac || ethLogger || hashPlaintext;
+        SHA256Impl::Hasher ptHasher;
+        ProgressBar progress(plainLen, 30, !quiet);
+        auto chunkLen = [&](unsigned long long index) { return (size_t)min(chunkSize, plainLen - index * chunkSize); };
+        auto plan = [&](size_t job, vector<AsyncIO::Span>& reads) {
+            unsigned long long first = (unsigned long long)job * batch;
+            size_t count = (size_t)min((unsigned long long)batch, nChunks - first);
+            size_t bytes = (count - 1) * stride + chunkLen(first + count - 1) + tagLen;
+            reads.push_back({bodyOffset + first * stride, 0, bytes});
+        };
+        auto open = [&](size_t job, unsigned char* slot, vector<AsyncIO::Span>& writes) {
+            unsigned long long first = (unsigned long long)job * batch;
+            size_t count = (size_t)min((unsigned long long)batch, nChunks - first);
+            atomic<bool> bad(false);
+            parallelFor(count, [&](size_t k) {
+                size_t len = chunkLen(first + k);
+                if (!openChunk(s, iv, first + k, chunkSize, slot + k*stride, len, slot + k*stride + len))
+                    bad = true;
+            });
+            if (bad) {
+                cerr << "\n❌ Chunk authentication failed - file tampered" << endl;
+                secure_memzero(slot, (count - 1) * stride + chunkLen(first + count - 1) + tagLen);
+                return false;
+            }
+            for (size_t k = 0; k < count; k++) {
+                size_t len = chunkLen(first + k);
+                writes.push_back({(first + k) * chunkSize, k*stride, len});
+                if (wantPtHash) ptHasher.update(slot + k*stride, len);
+                auth.update(slot + k*stride + len, tagLen);
+                progress.update(len);
+            }
+            return true;
+        };
+        size_t slotSize = (size_t)min((unsigned long long)batch * stride, plainLen + nChunks * tagLen);
+        if (!AsyncIO::run(inFd, outFd, (size_t)((nChunks + batch - 1) / max((size_t)1, batch)), slotSize,
+                          plan, open, ioEngine)) return false;
+        progress.finish();
+        if (wantPtHash) ptHash = ptHasher.final();
+        return true;
+    }
+    // Mapped v4 encrypt body: each chunk is copied from the input mapping
+    // straight into its slot in the preallocated output and sealed there;
+    // false if a chunk could not be sealed
+    bool encryptChunksMapped(MappedFile& src, MappedFile& dst, size_t bodyOffset, const unsigned char iv[16],
+                             unsigned long long plainLen, HeaderAuth& auth, SHA256Impl::Hasher* ptHasher,
+                             ProgressBar& progress) {
+        unsigned long long nChunks = chunkCount(plainLen, CHUNK_SIZE);
+        size_t batch = (size_t)min((unsigned long long)chunkBatch(CHUNK_SIZE), nChunks);
+        size_t tagLen = tagSize(suite), stride = CHUNK_SIZE + tagLen;
+        for (unsigned long long first = 0; first < nChunks; first += batch) {
+            size_t count = (size_t)min((unsigned long long)batch, nChunks - first);
+            unsigned long long offset = first * CHUNK_SIZE;
+            size_t bytes = (size_t)min((unsigned long long)count * CHUNK_SIZE, plainLen - offset);
+            src.willNeed((size_t)(offset + bytes), batch * CHUNK_SIZE);
+            const unsigned char* in = src.data() + offset;
+            if (ptHasher && bytes) ptHasher->update(in, bytes);
+            auto chunkLen = [&](size_t k) { return min((size_t)CHUNK_SIZE, bytes - min(bytes, k * CHUNK_SIZE)); };
+            unsigned char* out = dst.data() + bodyOffset + first * stride;
+            atomic<bool> bad(false);
+            parallelFor(count, [&](size_t k) {
+                size_t len = chunkLen(k);
+                unsigned char* c = out + k * stride;
+                if (len) memcpy(c, in + k * CHUNK_SIZE, len);
+                if (!sealChunk(suite, iv, first + k, CHUNK_SIZE, c, len, c + len)) bad = true;
+            });
+            if (bad) return false;
+            for (size_t k = 0; k < count; k++) auth.update(out + k * stride + chunkLen(k), tagLen);
+            progress.update(bytes);
+        }
+        return true;
+    }
+    // Mapped decrypt body: ciphertext is copied into the preallocated output
+    // and opened in place there; on failure the output is wiped
+    bool decryptChunksMapped(MappedFile& src, MappedFile& dst, size_t bodyOffset, HeaderAuth& auth, Suite s,
+                             const unsigned char iv[16], unsigned long long chunkSize, unsigned long long plainLen,
+                             vector<unsigned char>& ptHash) {
+        unsigned long long nChunks = chunkCount(plainLen, chunkSize);
+        size_t batch = (size_t)min((unsigned long long)chunkBatch((size_t)chunkSize), nChunks);
+        size_t tagLen = tagSize(s);
+        unsigned long long stride = chunkSize + tagLen;
+        bool wantPtHash = s == Suite::CtrHmac || ethLogger || hashPlaintext;
+        SHA256Impl::Hasher ptHasher;
+        ProgressBar progress(plainLen, 30, !quiet);
+        for (unsigned long long first = 0; first < nChunks; first += batch) {
+            size_t count = (size_t)min((unsigned long long)batch, nChunks - first);
+            const unsigned char* in = src.data() + bodyOffset + first * stride;
+            src.willNeed((size_t)(bodyOffset + (first + count) * stride), (size_t)(batch * stride));
+            unsigned char* out = dst.data() ? dst.data() + first * chunkSize : nullptr;
+            size_t bytes = (size_t)min((unsigned long long)count * chunkSize, plainLen - first * chunkSize);
+            auto chunkLen = [&](size_t k) { return (size_t)min(chunkSize, plainLen - (first + k) * chunkSize); };
+            atomic<bool> bad(false);
+            parallelFor(count, [&](size_t k) {
+                size_t len = chunkLen(k);
+                const unsigned char* c = in + k * stride;
+                if (len) memcpy(out + k * chunkSize, c, len);
+                if (!openChunk(s, iv, first + k, chunkSize, len ? out + k * chunkSize : nullptr, len, c + len))
+                    bad = true;
+            });
+            if (bad) {
+                cerr << "\n❌ Chunk authentication failed - file tampered" << endl;
+                if (dst.data()) secure_memzero(dst.data(), dst.size());
+                return false;
+            }
+            if (wantPtHash && bytes) ptHasher.update(out, bytes);
+            for (size_t k = 0; k < count; k++) auth.update(in + k * stride + chunkLen(k), tagLen);
+            progress.update(bytes);
+        }
+        progress.finish();
+        if (wantPtHash) ptHash = ptHasher.final();
+        return true;
     }
     // Constant-time HMAC verification
     bool verifyHMAC(const unsigned char* data, size_t dataLen, const unsigned char* expectedHmac) {
-        auto computed = computeHMAC(data, dataLen);
-        return constant_time_compare(computed.data(), expectedHmac, HMAC_SIZE);
+        unsigned char computed[HMAC_SIZE];
+        return computeHMAC(data, dataLen, computed) && constant_time_compare(computed, expectedHmac, HMAC_SIZE);
     }
 public:
     ~AESCipher() {
@@ -623,83 +1757,197 @@ public:
         }
         secure_memzero(encKey, 32);
         secure_memzero(authKey, 32);
+        clearKeyCache();
     }
+    void setCipherSuite(Suite s) { suite = s; }
+    void setIoMode(IoMode m) { ioMode = m; }
+    void setIoEngine(AsyncIO::Engine e) { ioEngine = e; }
+    void setQuiet(bool q) { quiet = q; }
+    // Callers that audit every file want FileResult::ptHash for gcm and chacha too
+    void setHashPlaintext(bool h) { hashPlaintext = h; }
+    static mutex& auditMutex() {
+        static mutex m;
+        return m;
+    }
+    // Independent context for another thread: same password, suite and KDF,
+    // sharing the derived-key store, so no worker repeats a derivation
+    AESCipher forkWorker() const { return AESCipher(*this); }
+    Suite cipherSuite() const { return suite; }
+    // New parameters get a new session master salt; keys already cached stay valid
+    void setKdf(const KdfParams& p) {
+        if (!kdfSane(p)) { cerr << "\n❌ Error: Invalid KDF parameters, keeping " << kdfName(kdfParams) << endl; return; }
+        kdfParams = p;
+        sessionSalt.clear();
+    }
+    const KdfParams& kdfSettings() const { return kdfParams; }
     void setKey(const string& password) {
         storedPassword.reserve(256);
         storedPassword = password;
+        kdf.setPassword(password);
+        clearKeyCache();
     }
-    vector<unsigned char> encrypt(const vector<unsigned char>& plaintext) {
-        // Generate random salt and IV
+    // Read every file's salt up front and derive all keys in one batch
+    // (SIMD lanes + all cores) instead of one 100k-iteration KDF per file.
+    // v4 PBKDF2 masters are batched per iteration count; Argon2id is already
+    // memory-bound and multi-lane, so those masters are derived one at a time.
+    // Entries are claimed under the store lock and derived without it, so
+    // forks keep decrypting with keys they already have.
+    void prefetchKeys(const vector<string>& files) {
+        set<string> fileSalts;
+        map<string, KdfParams> masters;
+        for (const auto& f : files) {
+            unsigned char salt[SALT_SIZE];
+            char version;
+            KdfParams params;
+            if (!readSalt(f, salt, version, params)) continue;
+            if (version != 0x04) fileSalts.insert(string((const char*)salt, SALT_SIZE));
+            else if (kdfSane(params)) masters[masterCacheKey(salt, params)] = params;
+        }
+        KeyStore& store = *keyStore;
+        vector<string> fileTodo;
+        map<unsigned int, vector<string>> byIterations;
+        {
+            lock_guard<mutex> lock(store.m);
+            for (const auto& salt : fileSalts)
+                if (!store.fileKeys.count(salt)) fileTodo.push_back(salt);
+            for (const auto& m : masters)
+                if (m.second.kdf == Kdf::Pbkdf2 && !store.masters.count(m.first)) {
+                    store.masters[m.first];   // claimed, see masterKey()
+                    byIterations[m.second.passes].push_back(m.first);
+                }
+        }
+        auto fileKeys = deriveSalts(fileTodo, PBKDF2_ITERATIONS);
+        map<unsigned int, vector<array<unsigned char, 64>>> masterKeys;
+        for (const auto& g : byIterations) masterKeys[g.first] = deriveSalts(g.second, g.first);
+        {
+            lock_guard<mutex> lock(store.m);
+            for (size_t i = 0; i < fileTodo.size(); i++) store.fileKeys[fileTodo[i]] = fileKeys[i];
+            for (const auto& g : byIterations)
+                for (size_t i = 0; i < g.second.size(); i++) {
+                    auto& entry = store.masters[g.second[i]];
+                    entry.key = masterKeys[g.first][i];
+                    entry.ready = true;
+                }
+            store.published.notify_all();
+        }
+        for (auto& k : fileKeys) secure_memzero(k.data(), 64);
+        for (auto& g : masterKeys)
+            for (auto& k : g.second) secure_memzero(k.data(), 64);
+        for (const auto& m : masters)
+            if (m.second.kdf == Kdf::Argon2id) masterKey((const unsigned char*)m.first.data(), m.second);
+    }
+    // Derive this session's master key now rather than on the first encryptFile()
+    bool prefetchMasterKey() {
         unsigned char salt[SALT_SIZE];
-        unsigned char iv[IV_SIZE];
+        if (!sessionMasterSalt(salt)) return false;
+        return masterKey(salt, kdfParams) != nullptr;
+    }
+    // ─── In-memory v1 blobs: salt | iv | CBC ciphertext | HMAC ───
+    // The payload sits at PAYLOAD_OFFSET in both directions, so a buffer of
+    // sealedSize(n) bytes is encrypted and decrypted without further copies.
+    static const size_t PAYLOAD_OFFSET = SALT_SIZE + IV_SIZE;
+    static size_t sealedSize(size_t plainLen) {
+        return PAYLOAD_OFFSET + (plainLen / 16 + 1) * 16 + HMAC_SIZE;
+    }
+    // buf holds sealedSize(plainLen) bytes with the plaintext at PAYLOAD_OFFSET;
+    // returns the sealed length, or 0 if no randomness was available or a primitive failed
+    size_t encryptInPlace(unsigned char* buf, size_t plainLen) {
+        unsigned char* salt = buf;
+        unsigned char* iv = buf + SALT_SIZE;
         if (!generateRandomBytes(salt, SALT_SIZE) || !generateRandomBytes(iv, IV_SIZE)) {
             cerr << "Error: Could not generate random salt/IV" << endl;
-            return {};
+            return 0;
         }
-        // Derive keys from password + salt
-        deriveKeys(salt);
-        // Pad plaintext
-        auto padded = pkcs7Pad(plaintext);
-        // Build result: salt + iv + ciphertext (HMAC added at end)
-        vector<unsigned char> result;
-        result.insert(result.end(), salt, salt + SALT_SIZE);
-        result.insert(result.end(), iv, iv + IV_SIZE);
-        // CBC encrypt
-        unsigned char prev[16];
-        memcpy(prev, iv, 16);
-        for (size_t i = 0; i < padded.size(); i += 16) {
-            unsigned char block[16];
-            for (int j = 0; j < 16; j++) block[j] = padded[i+j] ^ prev[j];
-            ctx.encryptBlock(block);
-            result.insert(result.end(), block, block + 16);
-            memcpy(prev, block, 16);
-        }
-        // Compute and append HMAC over salt + iv + ciphertext
-        auto hmac = computeHMAC(result.data(), result.size());
-        result.insert(result.end(), hmac.begin(), hmac.end());
-        // Secure cleanup
-        secure_memzero(salt, SALT_SIZE);
-        secure_memzero(iv, IV_SIZE);
-        
-        return result;
+        if (!deriveKeys(salt)) return 0;
+        unsigned char* data = buf + PAYLOAD_OFFSET;
+        size_t padLen = 16 - plainLen % 16, encLen = plainLen + padLen;
+        memset(data + plainLen, (int)padLen, padLen);
+        // CBC encrypt: serial by construction, each block chains off the last
+        const unsigned char* prev = iv;
+        for (size_t i = 0; i < encLen; i += 16) {
+            for (int j = 0; j < 16; j++) data[i + j] ^= prev[j];
+            ctx.encryptBlock(data + i);
+            prev = data + i;
+        }
+        // HMAC over salt + iv + ciphertext
+        if (!computeHMAC(buf, PAYLOAD_OFFSET + encLen, data + encLen)) {
+            secure_memzero(buf, PAYLOAD_OFFSET + encLen + HMAC_SIZE);
+            cerr << "Error: HMAC computation failed" << endl;
+            return 0;
+        }
+        return PAYLOAD_OFFSET + encLen + HMAC_SIZE;
     }
-    vector<unsigned char> decrypt(const vector<unsigned char>& ciphertext) {
+    // buf holds a sealed blob of `len` bytes; on success the plaintext is at
+    // PAYLOAD_OFFSET and plainLen is set. Nothing is decrypted unless the HMAC matches.
+    bool decryptInPlace(unsigned char* buf, size_t len, size_t& plainLen) {
         // Minimum size: salt(16) + iv(16) + one block(16) + hmac(32) = 80 bytes
-        if (ciphertext.size() < 80) return {};
-        
-        size_t dataLen = ciphertext.size() - HMAC_SIZE;
-        if ((dataLen - SALT_SIZE - IV_SIZE) % 16 != 0) return {};
-        // Extract components
-        const unsigned char* salt = ciphertext.data();
-        const unsigned char* iv = ciphertext.data() + SALT_SIZE;
-        const unsigned char* encData = ciphertext.data() + SALT_SIZE + IV_SIZE;
-        const unsigned char* hmac = ciphertext.data() + dataLen;
-        size_t encLen = dataLen - SALT_SIZE - IV_SIZE;
-        // Derive keys from password + salt
-        deriveKeys(salt);
+        if (len < PAYLOAD_OFFSET + 16 + HMAC_SIZE) return false;
+        size_t dataLen = len - HMAC_SIZE, encLen = dataLen - PAYLOAD_OFFSET;
+        if (encLen % 16 != 0) return false;
+        if (!deriveKeys(buf)) return false;
         // Verify HMAC BEFORE decryption (Encrypt-then-MAC)
-        if (!verifyHMAC(ciphertext.data(), dataLen, hmac)) {
+        if (!verifyHMAC(buf, dataLen, buf + dataLen)) {
             cerr << "\n❌ HMAC verification failed - file tampered or wrong password" << endl;
-            return {};
+            return false;
         }
-        // CBC decrypt
+        unsigned char* data = buf + PAYLOAD_OFFSET;
+        cbcDecrypt(data, data, encLen, buf + SALT_SIZE);
+        size_t pad = pkcs7PadLength(data, encLen);
+        if (!pad) return false;
+        plainLen = encLen - pad;
+        return true;
+    }
+    // Vector forms: `data` goes from plaintext to sealed blob (or back) in place.
+    // Reserving sealedSize() up front avoids the one reallocation on encrypt.
+    bool encryptInPlace(vector<unsigned char>& data) {
+        size_t plainLen = data.size();
+        data.resize(sealedSize(plainLen));
+        memmove(data.data() + PAYLOAD_OFFSET, data.data(), plainLen);
+        size_t sealed = encryptInPlace(data.data(), plainLen);
+        if (!sealed) { secure_memzero(data.data(), data.size()); data.clear(); return false; }
+        data.resize(sealed);
+        return true;
+    }
+    bool decryptInPlace(vector<unsigned char>& data) {
+        size_t plainLen = 0;
+        if (!decryptInPlace(data.data(), data.size(), plainLen)) return false;
+        memmove(data.data(), data.data() + PAYLOAD_OFFSET, plainLen);
+        secure_memzero(data.data() + plainLen, data.size() - plainLen);
+        data.resize(plainLen);
+        return true;
+    }
+    vector<unsigned char> encrypt(const vector<unsigned char>& plaintext) {
         vector<unsigned char> result;
-        unsigned char prev[16];
-        memcpy(prev, iv, 16);
-        for (size_t i = 0; i < encLen; i += 16) {
-            unsigned char block[16];
-            memcpy(block, encData + i, 16);
-            unsigned char enc[16];
-            memcpy(enc, block, 16);
-            ctx.decryptBlock(block);
-            for (int j = 0; j < 16; j++) block[j] ^= prev[j];
-            result.insert(result.end(), block, block + 16);
-            memcpy(prev, enc, 16);
-        }
-        if (!pkcs7Unpad(result)) return {};
+        result.reserve(sealedSize(plaintext.size()));
+        result.assign(plaintext.begin(), plaintext.end());
+        if (!encryptInPlace(result)) return {};
+        return result;
+    }
+    vector<unsigned char> decrypt(const vector<unsigned char>& ciphertext) {
+        vector<unsigned char> result(ciphertext);
+        if (!decryptInPlace(result)) { secure_memzero(result.data(), result.size()); return {}; }
         return result;
     }
-    bool encryptFile(const string& inputFile, const string& outputFile) {
+    static double msSince(chrono::steady_clock::time_point t) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - t).count();
+    }
+    FileResult encryptFile(const string& inputFile, const string& outputFile) {
+        FileResult r;
+        auto t0 = chrono::steady_clock::now();
+        r.ok = encryptFile(inputFile, outputFile, r);
+        r.totalMs = msSince(t0);
+        return r;
+    }
+    FileResult decryptFile(const string& inputFile, const string& outputFile) {
+        FileResult r;
+        auto t0 = chrono::steady_clock::now();
+        r.ok = decryptFile(inputFile, outputFile, r);
+        r.totalMs = msSince(t0);
+        return r;
+    }
+private:
+    bool encryptFile(const string& inputFile, const string& outputFile, FileResult& result) {
+        auto stage = chrono::steady_clock::now();
         ifstream in(inputFile, ios::binary);
         if (!in.is_open()) { cerr << "\n❌ Error: Cannot open '" << inputFile << "'" << endl; return false; }
         
@@ -707,78 +1955,143 @@ public:
         long long fileSize = in.tellg();
         in.seekg(0, ios::beg);
 
-        unsigned char salt[SALT_SIZE], iv[IV_SIZE];
-        if (!generateRandomBytes(salt, SALT_SIZE) || !generateRandomBytes(iv, IV_SIZE)) return false;
-        deriveKeys(salt);
-        
-        ofstream out(outputFile, ios::binary);
-        if (!out.is_open()) { cerr << "\n❌ Error: Cannot create '" << outputFile << "'" << endl; return false; }
-
-        out.write("CVPF", 4);
-        char version = 0x02;
-        out.write(&version, 1);
-        out.write((char*)salt, SALT_SIZE);
-        out.write((char*)iv, IV_SIZE);
-        
-        long long placeholdersOffset = out.tellp();
-        char zeroes[64] = {0};
-        out.write(zeroes, 64);
+        // Envelope: a fresh random data key per file, wrapped by the session master key
+        unsigned char salt[SALT_SIZE], iv[IV_SIZE], wrap[WRAP_SIZE];
+        if (!sessionMasterSalt(salt) || !generateRandomBytes(iv, IV_SIZE)
+            || !generateRandomBytes(wrap, DATA_KEY_SIZE)) return false;
+        const unsigned char* master = masterKey(salt, kdfParams);
+        if (!master) return false;
+        useKeys(wrap);
+        result.keyMs = msSince(stage);
 
-        HMAC_SHA256 hmac(authKey, 32);
-        hmac.update((const unsigned char*)"CVPF", 4);
-        hmac.update((const unsigned char*)&version, 1);
-        hmac.update(salt, SALT_SIZE);
-        hmac.update(iv, IV_SIZE);
+        // Large files: both sides mapped, the output preallocated at its exact size
+        unsigned long long plainLen = fileSize > 0 ? (unsigned long long)fileSize : 0;
+        unsigned long long nChunks = chunkCount(plainLen, CHUNK_SIZE);
+        size_t tagLen = tagSize(suite);
+        const size_t headerSize = V4_PREFIX_SIZE + WRAP_SIZE + HMAC_SIZE + 32;
+        MappedFile src, dst;
+        bool mapped = useMapped(plainLen) && src.openRead(inputFile) && src.size() == plainLen
+                   && dst.create(outputFile, (size_t)(headerSize + plainLen + nChunks * tagLen));
+        // Otherwise the body streams through the AsyncIO pipeline
+        int inFd = -1, outFd = -1;
+        if (!mapped) {
+            src.close(); dst.close();
+            inFd = AsyncIO::openRead(inputFile);
+            outFd = AsyncIO::openWrite(outputFile);
+            if (inFd < 0 || outFd < 0) {
+                AsyncIO::closeFd(inFd); AsyncIO::closeFd(outFd);
+                cerr << "\n❌ Error: Cannot create '" << outputFile << "'" << endl;
+                return false;
+            }
+        }
+        auto abandon = [&](const string& msg) {
+            in.close(); AsyncIO::closeFd(inFd); AsyncIO::closeFd(outFd); dst.close(); src.close();
+            remove(outputFile.c_str());
+            if (!msg.empty()) cerr << "\n❌ Error: " << msg << endl;
+            return false;
+        };
+
+        char version = 0x04;
+        unsigned char prefix[V4_PREFIX_SIZE], *kcv = prefix + 6 + SALT_SIZE + IV_SIZE;
+        memcpy(prefix, "CVPF", 4);
+        prefix[4] = (unsigned char)version;
+        prefix[5] = (unsigned char)suite;
+        memcpy(prefix + 6, salt, SALT_SIZE);
+        memcpy(prefix + 6 + SALT_SIZE, iv, IV_SIZE);
+        computeKeyCheck(master + 32, version, salt, iv, kcv);
+        putBE(kcv + KCV_SIZE, CHUNK_SIZE, 4);
+        putBE(kcv + KCV_SIZE + 4, plainLen, 8);
+        putKdfParams(prefix + V3_PREFIX_SIZE, kdfParams);
+        if (!wrapDataKey(master, prefix, wrap)) return abandon("");
+        const long long placeholdersOffset = V4_PREFIX_SIZE + WRAP_SIZE;
+        if (mapped) {
+            memcpy(dst.data(), prefix, sizeof(prefix));
+            memcpy(dst.data() + V4_PREFIX_SIZE, wrap, WRAP_SIZE);
+        } else {
+            unsigned char zeroes[64] = {0};
+            if (!AsyncIO::writeAt(outFd, prefix, sizeof(prefix), 0) || !AsyncIO::writeAt(outFd, wrap, WRAP_SIZE, V4_PREFIX_SIZE)
+                || !AsyncIO::writeAt(outFd, zeroes, 64, placeholdersOffset))
+                return abandon("Failed to write header to '" + outputFile + "'");
+        }
+
+        // Header tag binds the header fields, every chunk tag in order, and ptHash
+        HeaderAuth auth(*this, suite, iv);
+        auth.update(prefix, sizeof(prefix));
+        auth.update(wrap, WRAP_SIZE);
 
+        // ctr-hmac keeps its plaintext hash; the AEAD suites skip the SHA-256 pass unless auditing needs it
+        bool wantPtHash = suite == Suite::CtrHmac || ethLogger || hashPlaintext;
         SHA256Impl::Hasher ptHasher;
+        ProgressBar progress(fileSize, 30, !quiet);
+        size_t batch = (size_t)min((unsigned long long)chunkBatch(CHUNK_SIZE), nChunks);
+        size_t stride = CHUNK_SIZE + tagLen;
+        auto chunkLen = [&](unsigned long long index) { return (size_t)min((unsigned long long)CHUNK_SIZE, plainLen - min(plainLen, index * CHUNK_SIZE)); };
 
-        ProgressBar progress(fileSize, 30);
-        unsigned char prev[16]; memcpy(prev, iv, 16);
-        vector<unsigned char> buffer(131072); // 128KB buffer
-
-        while (in.read((char*)buffer.data(), buffer.size()) || in.gcount() > 0) {
-            size_t bytesRead = in.gcount();
-            ptHasher.update((const unsigned char*)buffer.data(), bytesRead);
-            vector<unsigned char> chunk(buffer.begin(), buffer.begin() + bytesRead);
-            if (in.eof()) chunk = pkcs7Pad(chunk);
-            
-            for (size_t i = 0; i < chunk.size(); i += 16) {
-                unsigned char block[16];
-                for (int j = 0; j < 16; j++) block[j] = chunk[i+j] ^ prev[j];
-                ctx.encryptBlock(block);
-                out.write((char*)block, 16);
-                hmac.update(block, 16);
-                memcpy(prev, block, 16);
-            }
-            if (in.eof()) break;
-            progress.update(bytesRead);
-        }
-        auto ptHash = ptHasher.final();
-        hmac.update(ptHash.data(), 32);
-        auto h = hmac.final();
-
-        out.seekp(placeholdersOffset, ios::beg);
-        if (!out) {
-            in.close(); out.close(); remove(outputFile.c_str());
-            cerr << "\n❌ Error: seekp failed — header injection unsuccessful" << endl;
-            return false;
-        }
-        
-        out.write((char*)h.data(), 32);
-        out.write((char*)ptHash.data(), 32);
-        if (!out) {
-            in.close(); out.close(); remove(outputFile.c_str());
-            cerr << "\n❌ Error: Failed to write hashes to header" << endl;
-            return false;
+        if (mapped) {
+            if (!encryptChunksMapped(src, dst, headerSize, iv, plainLen, auth, wantPtHash ? &ptHasher : nullptr, progress))
+                return abandon("Chunk encryption failed");
+        } else {
+            // Each chunk is read into its slot position, sealed in place with the
+            // tag after it, and the batch leaves as one contiguous write
+            auto plan = [&](size_t job, vector<AsyncIO::Span>& reads) {
+                unsigned long long first = (unsigned long long)job * batch;
+                size_t count = (size_t)min((unsigned long long)batch, nChunks - first);
+                for (size_t k = 0; k < count; k++)
+                    reads.push_back({(first + k) * CHUNK_SIZE, k*stride, chunkLen(first + k)});
+            };
+            auto seal = [&](size_t job, unsigned char* slot, vector<AsyncIO::Span>& writes) {
+                unsigned long long first = (unsigned long long)job * batch;
+                size_t count = (size_t)min((unsigned long long)batch, nChunks - first);
+                size_t bytes = 0;
+                for (size_t k = 0; k < count; k++) {
+                    if (wantPtHash) ptHasher.update(slot + k*stride, chunkLen(first + k));
+                    bytes += chunkLen(first + k);
+                }
+                atomic<bool> bad(false);
+                parallelFor(count, [&](size_t k) {
+                    size_t len = chunkLen(first + k);
+                    if (!sealChunk(suite, iv, first + k, CHUNK_SIZE, slot + k*stride, len, slot + k*stride + len))
+                        bad = true;
+                });
+                if (bad) {
+                    cerr << "\n❌ Error: Chunk encryption failed" << endl;
+                    return false;
+                }
+                for (size_t k = 0; k < count; k++) auth.update(slot + k*stride + chunkLen(first + k), tagLen);
+                writes.push_back({headerSize + first * stride, 0, (count - 1) * stride + chunkLen(first + count - 1) + tagLen});
+                progress.update(bytes);
+                return true;
+            };
+            size_t slotSize = (size_t)min((unsigned long long)batch * stride, plainLen + nChunks * tagLen);
+            if (!AsyncIO::run(inFd, outFd, (size_t)((nChunks + batch - 1) / batch), slotSize, plan, seal, ioEngine))
+                return abandon("");
         }
+        vector<unsigned char> ptHash(32, 0);
+        if (wantPtHash) ptHash = ptHasher.final();
+        result.bodyMs = msSince(stage) - result.keyMs;
+        auth.update(ptHash.data(), 32);
+        unsigned char h[32];
+        auth.final(h);
 
+        if (mapped) {
+            memcpy(dst.data() + placeholdersOffset, h, 32);
+            memcpy(dst.data() + placeholdersOffset + 32, ptHash.data(), 32);
+            dst.close(); src.close();
+        } else if (!AsyncIO::writeAt(outFd, h, 32, placeholdersOffset)
+                   || !AsyncIO::writeAt(outFd, ptHash.data(), 32, placeholdersOffset + 32)) {
+            return abandon("Failed to write hashes to header");
+        }
         progress.finish();
-        in.close(); out.close();
+        in.close(); AsyncIO::closeFd(inFd); AsyncIO::closeFd(outFd);
+        if (wantPtHash) result.ptHash = ptHash;
+        result.plainSize = plainLen;
+        result.cipherSize = headerSize + plainLen + nChunks * tagLen;
 
         if (ethLogger) {
             try {
                 std::array<uint8_t, 32> ptHashArr = {0};
                 std::copy_n(ptHash.begin(), std::min((size_t)32, ptHash.size()), ptHashArr.begin());
+                lock_guard<mutex> serial(auditMutex());   // directory workers share the logger
                 auto txHash = ethLogger->logOperation(ptHashArr, EthLogger::OpType::ENCRYPT, std::filesystem::path(inputFile).filename().string());
                 cout << "\n[Ethereum] Logged - tx: " << txHash.substr(0, 18) << "..." << endl;
             } catch (const exception& e) {
@@ -788,7 +2101,8 @@ public:
         return true;
     }
 
-    bool decryptFile(const string& inputFile, const string& outputFile) {
+    bool decryptFile(const string& inputFile, const string& outputFile, FileResult& result) {
+        auto stage = chrono::steady_clock::now();
         FileLocker lockIn(inputFile);
         FileLocker lockOut(outputFile);
         if (!lockIn.isLocked() || !lockOut.isLocked()) {
@@ -811,16 +2125,52 @@ public:
         unsigned char expectedHmac[HMAC_SIZE];
         unsigned char expectedPtHash[32] = {0};
         unsigned char salt[SALT_SIZE], iv[IV_SIZE];
+        unsigned char prefix[V4_PREFIX_SIZE], *kcv = prefix + 6 + SALT_SIZE + IV_SIZE;
+        unsigned char wrap[WRAP_SIZE];
+        unsigned long long chunkSize = 0, plainLen = 0;
+        Suite fileSuite = Suite::CtrHmac;
+        KdfParams fileKdf;
+        char version = 0;
+        int prefixLen = V3_PREFIX_SIZE;
 
         if (isV2) {
-            char version;
             in.read(&version, 1);
-            if (version != 0x02) { cerr << "\n❌ Error: Unsupported version" << endl; return false; }
-            in.read((char*)salt, SALT_SIZE);
-            in.read((char*)iv, IV_SIZE);
+            if (version == 0x03 || version == 0x04) {
+                memcpy(prefix, magic, 4);
+                prefix[4] = (unsigned char)version;
+                if (version == 0x04) prefixLen = V4_PREFIX_SIZE;
+                in.read((char*)prefix + 5, prefixLen - 5);
+                if (version == 0x04) {
+                    in.read((char*)wrap, WRAP_SIZE);
+                    fileKdf = getKdfParams(prefix + V3_PREFIX_SIZE);
+                    if (in && !kdfSane(fileKdf)) {
+                        cerr << "\n❌ Error: Unsupported or unsafe KDF parameters" << endl; return false;
+                    }
+                }
+                fileSuite = (Suite)prefix[5];
+                memcpy(salt, prefix + 6, SALT_SIZE);
+                memcpy(iv, prefix + 6 + SALT_SIZE, IV_SIZE);
+                chunkSize = getBE(kcv + KCV_SIZE, 4);
+                plainLen = getBE(kcv + KCV_SIZE + 4, 8);
+                if (fileSuite != Suite::CtrHmac && fileSuite != Suite::Gcm && fileSuite != Suite::ChaCha) {
+                    cerr << "\n❌ Error: Unsupported cipher suite" << endl; return false;
+                }
+            } else if (version == 0x02) {
+                in.read((char*)salt, SALT_SIZE);
+                in.read((char*)iv, IV_SIZE);
+            } else { cerr << "\n❌ Error: Unsupported version" << endl; return false; }
             in.read((char*)expectedHmac, HMAC_SIZE);
             in.read((char*)expectedPtHash, 32);
+            if (!in) { cerr << "\n❌ Error: Truncated header" << endl; return false; }
             ciphertextLen = totalSize - 4 - 1 - SALT_SIZE - IV_SIZE - HMAC_SIZE - 32;
+            if (version >= 0x03) {
+                unsigned long long headerSize = prefixLen + HMAC_SIZE + 32 + (version == 0x04 ? WRAP_SIZE : 0);
+                bool sane = chunkSize >= 16 && chunkSize <= (64u << 20) && chunkSize % 16 == 0
+                         && plainLen <= (unsigned long long)totalSize
+                         && (unsigned long long)totalSize == headerSize + plainLen
+                                                             + chunkCount(plainLen, chunkSize) * tagSize(fileSuite);
+                if (!sane) { cerr << "\n❌ Error: Truncated or malformed v" << (int)version << " container" << endl; return false; }
+            }
         } else {
             in.seekg(0, ios::beg);
             if (totalSize < (SALT_SIZE + IV_SIZE + HMAC_SIZE)) return false;
@@ -829,110 +2179,171 @@ public:
             in.read((char*)iv, IV_SIZE);
         }
 
-        deriveKeys(salt);
+        if (version == 0x04) {
+            const unsigned char* master = masterKey(salt, fileKdf);
+            if (!master) return false;
+            unsigned char expectedKcv[KCV_SIZE], dataKey[DATA_KEY_SIZE];
+            computeKeyCheck(master + 32, version, salt, iv, expectedKcv);
+            if (!constant_time_compare(expectedKcv, kcv, KCV_SIZE)) {
+                cerr << "\n❌ Wrong password" << endl;
+                return false;
+            }
+            if (!unwrapDataKey(master, prefix, wrap, dataKey)) {
+                cerr << "\n❌ Key unwrap failed - file tampered" << endl;
+                return false;
+            }
+            useKeys(dataKey);
+            secure_memzero(dataKey, DATA_KEY_SIZE);
+        } else if (!deriveKeys(salt)) {
+            return false;
+        }
+
+        if (version == 0x03) {
+            unsigned char expectedKcv[KCV_SIZE];
+            computeKeyCheck(authKey, version, salt, iv, expectedKcv);
+            if (!constant_time_compare(expectedKcv, kcv, KCV_SIZE)) {
+                cerr << "\n❌ Wrong password" << endl;
+                return false;
+            }
+        }
+
+        if (version < 0x03 && (ciphertextLen <= 0 || ciphertextLen % 16 != 0)) {
+            cerr << "\n❌ Error: Truncated or malformed ciphertext" << endl;
+            return false;
+        }
+        result.keyMs = msSince(stage);
 
-        // --- Pass 1: HMAC Verification ---
-        cout << "  [1/2] Verifying Integrity..." << endl;
+        // --- Single pass: MAC, decrypt and hash each chunk as it is read ---
+        // Plaintext only goes to a temp file, renamed over the output once the
+        // HMAC and plaintext hash both match.
+        if (!quiet) cout << "  Decrypting & verifying..." << endl;
         HMAC_SHA256 hmac(authKey, 32);
         if (isV2) {
-            char version = 0x02;
             hmac.update((const unsigned char*)"CVPF", 4);
             hmac.update((const unsigned char*)&version, 1);
         }
         hmac.update(salt, SALT_SIZE);
         hmac.update(iv, IV_SIZE);
 
-        long long dataStartOffset = in.tellg();
-        vector<unsigned char> buffer(131072); // 128KB
-        long long remaining = ciphertextLen;
-        while (remaining > 0) {
-            size_t toRead = (size_t)min((long long)buffer.size(), remaining);
-            in.read((char*)buffer.data(), toRead);
-            hmac.update(buffer.data(), toRead);
-            remaining -= toRead;
-        }
-
-        if (isV2) {
-            hmac.update(expectedPtHash, 32);
-        } else {
-            in.read((char*)expectedHmac, HMAC_SIZE);
+        string tempOutFile = outputFile + ".tmp";
+        // v3/v4 bodies of large files are opened through mappings (see encryptFile)
+        MappedFile src, dst;
+        bool mapped = version >= 0x03 && useMapped((unsigned long long)totalSize)
+                   && src.openRead(inputFile) && src.size() == (size_t)totalSize && dst.create(tempOutFile, (size_t)plainLen);
+        // Smaller v3/v4 bodies go through the AsyncIO pipeline; v1/v2 keep the stream
+        ofstream out;
+        int inFd = -1, outFd = -1;
+        if (!mapped) {
+            src.close(); dst.close();
+            bool created;
+            if (version >= 0x03) {
+                inFd = AsyncIO::openRead(inputFile);
+                outFd = AsyncIO::openWrite(tempOutFile);
+                created = inFd >= 0 && outFd >= 0;
+            } else {
+                out.open(tempOutFile, ios::binary);
+                created = out.is_open();
+            }
+            if (!created) {
+                AsyncIO::closeFd(inFd); AsyncIO::closeFd(outFd);
+                cerr << "\n❌ Error: Cannot create '" << tempOutFile << "'" << endl;
+                return false;
+            }
         }
-
-        auto computedHmac = hmac.final();
-        if (!constant_time_compare(computedHmac.data(), expectedHmac, HMAC_SIZE)) {
-            cerr << "\n❌ HMAC verification failed - file tampered or wrong password" << endl;
+        auto discard = [&](const char* msg) {
+            out.close(); in.close(); dst.close(); src.close(); AsyncIO::closeFd(inFd); AsyncIO::closeFd(outFd);
+            remove(tempOutFile.c_str());
+            if (msg) cerr << "\n❌ " << msg << endl;
             return false;
-        }
+        };
 
-        // --- Pass 2: Decryption ---
-        cout << "  [2/2] Decrypting Content..." << endl;
-        in.clear(); // Reset EOF
-        in.seekg(dataStartOffset, ios::beg);
-        
-        string tempOutFile = outputFile + ".tmp";
-        ofstream out(tempOutFile, ios::binary);
-        if (!out.is_open()) return false;
+        vector<unsigned char> computedPtHash;
+        if (version >= 0x03) {
+            HeaderAuth auth(*this, fileSuite, iv);
+            auth.update(prefix, prefixLen);
+            if (version == 0x04) auth.update(wrap, WRAP_SIZE);
+            bool opened = mapped
+                ? decryptChunksMapped(src, dst, (size_t)totalSize - (size_t)(plainLen + chunkCount(plainLen, chunkSize) * tagSize(fileSuite)),
+                                      auth, fileSuite, iv, chunkSize, plainLen, computedPtHash)
+                : decryptChunks(inFd, outFd, (unsigned long long)totalSize - plainLen - chunkCount(plainLen, chunkSize) * tagSize(fileSuite),
+                                auth, fileSuite, iv, chunkSize, plainLen, computedPtHash);
+            if (!opened) return discard(nullptr);   // the chunk loop reported the cause
+            auth.update(expectedPtHash, 32);
+            unsigned char headerTag[32];
+            auth.final(headerTag);
+            if (!constant_time_compare(headerTag, expectedHmac, HMAC_SIZE))
+                return discard("Header authentication failed - file tampered");
+        } else {
+            SHA256Impl::Hasher ptHasher;
+            SHA256Impl::Hasher* streams[2] = {&hmac.innerHasher(), &ptHasher};
+            ProgressBar progress(ciphertextLen, 30, !quiet);
+            unsigned char prev[16]; memcpy(prev, iv, 16);
+            vector<unsigned char> buffer(CBC_SLICE * min(workerCount(), (size_t)32));
+            vector<unsigned char> plain(buffer.size());
+            vector<unsigned char> lastBlock;
+            long long remaining = ciphertextLen;
+            while (remaining > 0) {
+                size_t toRead = (size_t)min((long long)buffer.size(), remaining);
+                if (!in.read((char*)buffer.data(), toRead)) return discard("Error: Unexpected end of file");
+                cbcDecrypt(buffer.data(), plain.data(), toRead, prev);
+                memcpy(prev, buffer.data() + toRead - 16, 16);
 
-        SHA256Impl::Hasher ptHasher;
-        ProgressBar progress(ciphertextLen, 30);
-        unsigned char prev[16]; memcpy(prev, iv, 16);
-        
-        remaining = ciphertextLen;
-        vector<unsigned char> lastBlock;
-        while (remaining > 0) {
-            size_t toRead = (size_t)min((long long)buffer.size(), remaining);
-            in.read((char*)buffer.data(), toRead);
-            for (size_t i = 0; i < toRead; i += 16) {
-                unsigned char block[16], enc[16];
-                memcpy(block, buffer.data() + i, 16);
-                memcpy(enc, block, 16);
-                ctx.decryptBlock(block);
-                for (int j = 0; j < 16; j++) block[j] ^= prev[j];
-                memcpy(prev, enc, 16);
-                
-                if (remaining <= 16 && i + 16 >= toRead) {
-                    lastBlock.assign(block, block + 16);
-                } else {
-                    out.write((char*)block, 16);
-                    ptHasher.update(block, 16);
+                // Padding lives in the final block; hold it back until unpadded
+                size_t emit = toRead;
+                if (remaining == (long long)toRead) {
+                    emit -= 16;
+                    lastBlock.assign(plain.begin() + emit, plain.begin() + toRead);
                 }
+                out.write((char*)plain.data(), emit);
+                const unsigned char* parts[2] = {buffer.data(), plain.data()};
+                size_t lens[2] = {toRead, emit};
+                SHA256Impl::updateMany(streams, parts, lens, 2);
+                remaining -= toRead;
+                progress.update(toRead);
             }
-            remaining -= toRead;
-            progress.update(toRead);
-        }
 
-        if (!pkcs7Unpad(lastBlock)) {
-            out.close();
-            remove(tempOutFile.c_str());
-            return false;
+            if (isV2) {
+                hmac.update(expectedPtHash, 32);
+            } else {
+                in.read((char*)expectedHmac, HMAC_SIZE);
+            }
+            auto computedHmac = hmac.final();
+            if (!constant_time_compare(computedHmac.data(), expectedHmac, HMAC_SIZE))
+                return discard("HMAC verification failed - file tampered or wrong password");
+
+            if (!pkcs7Unpad(lastBlock)) return discard("Error: Invalid padding");
+            out.write((char*)lastBlock.data(), lastBlock.size());
+            ptHasher.update(lastBlock.data(), lastBlock.size());
+            secure_memzero(plain.data(), plain.size());
+
+            computedPtHash = ptHasher.final();
+            plainLen = (unsigned long long)ciphertextLen - 16 + lastBlock.size();
+            progress.finish();
         }
-        
-        out.write((char*)lastBlock.data(), lastBlock.size());
-        ptHasher.update(lastBlock.data(), lastBlock.size());
-        
+        result.bodyMs = msSince(stage) - result.keyMs;
+
+        bool checkPtHash = version == 0x02 || (version >= 0x03 && fileSuite == Suite::CtrHmac);
+        if (checkPtHash && memcmp(computedPtHash.data(), expectedPtHash, 32) != 0)
+            return discard("Integrity check failed: decrypted content does not match original.");
+        if (out.is_open() && !out.flush()) return discard("Error: Failed to write decrypted output");
         out.close();
         in.close();
-        progress.finish();
+        dst.close(); src.close(); AsyncIO::closeFd(inFd); AsyncIO::closeFd(outFd);
 
-        auto computedPtHash = ptHasher.final();
-        if (isV2) {
-            if (memcmp(computedPtHash.data(), expectedPtHash, 32) != 0) {
-                remove(tempOutFile.c_str());
-                cerr << "\n❌ Integrity check failed: decrypted content does not match original." << endl;
-                return false;
-            }
-        }
-        
         remove(outputFile.c_str());
         if (rename(tempOutFile.c_str(), outputFile.c_str()) != 0) {
             cerr << "\n❌ Failed to rename temp file." << endl;
             return false;
         }
+        result.ptHash = computedPtHash;
+        result.plainSize = plainLen;
+        result.cipherSize = (unsigned long long)totalSize;
 
         if (ethLogger) {
             try {
                 std::array<uint8_t, 32> computedPtHashArr = {0};
                 std::copy_n(computedPtHash.begin(), std::min((size_t)32, computedPtHash.size()), computedPtHashArr.begin());
+                lock_guard<mutex> serial(auditMutex());   // directory workers share the logger
                 auto txHash = ethLogger->logOperation(computedPtHashArr, EthLogger::OpType::DECRYPT, std::filesystem::path(inputFile).filename().string());
                 cout << "\n[Ethereum] Logged - tx: " << txHash.substr(0, 18) << "..." << endl;
             } catch (const exception& e) {
@@ -942,16 +2353,116 @@ public:
 
         return true;
     }
+public:
+    // Password rotation for v4 files: unwrap the data key with this cipher's
+    // password and re-wrap it under `target`'s session master key. Bodies are
+    // untouched; chunk tags are read by seeking past each chunk so the header
+    // tag can be checked and re-signed, then the header is rewritten in place
+    // and synced. The rewrite is not atomic: a crash mid-write can leave a
+    // header that opens with neither password, so keep a backup of anything
+    // that cannot be re-encrypted from its plaintext.
+    bool rekeyFile(const string& file, AESCipher& target) {
+        FileLocker lock(file);
+        if (!lock.isLocked()) { cerr << "\n❌ Error: File is locked by another process" << endl; return false; }
+        fstream f(file, ios::in | ios::out | ios::binary);
+        if (!f.is_open()) { cerr << "\n❌ Error: Cannot open '" << file << "'" << endl; return false; }
+        f.seekg(0, ios::end);
+        unsigned long long totalSize = (unsigned long long)f.tellg();
+        f.seekg(0, ios::beg);
+
+        unsigned char prefix[V4_PREFIX_SIZE], wrap[WRAP_SIZE], headerTag[HMAC_SIZE], ptHash[32];
+        unsigned char *salt = prefix + 6, *iv = salt + SALT_SIZE, *kcv = iv + IV_SIZE;
+        const unsigned long long headerSize = V4_PREFIX_SIZE + WRAP_SIZE + HMAC_SIZE + 32;
+        f.read((char*)prefix, V4_PREFIX_SIZE);
+        f.read((char*)wrap, WRAP_SIZE);
+        f.read((char*)headerTag, HMAC_SIZE);
+        f.read((char*)ptHash, 32);
+        if (!f || memcmp(prefix, "CVPF", 4) != 0 || prefix[4] != 0x04) {
+            cerr << "\n❌ Error: Not a v4 CVPF file (re-encrypt older formats instead)" << endl;
+            return false;
+        }
+        Suite fileSuite = (Suite)prefix[5];
+        unsigned long long chunkSize = getBE(kcv + KCV_SIZE, 4), plainLen = getBE(kcv + KCV_SIZE + 4, 8);
+        KdfParams fileKdf = getKdfParams(prefix + V3_PREFIX_SIZE);
+        bool sane = (fileSuite == Suite::CtrHmac || fileSuite == Suite::Gcm || fileSuite == Suite::ChaCha)
+                 && kdfSane(fileKdf)
+                 && chunkSize >= 16 && chunkSize <= (64u << 20) && chunkSize % 16 == 0
+                 && plainLen <= totalSize
+                 && totalSize == headerSize + plainLen + chunkCount(plainLen, chunkSize) * tagSize(fileSuite);
+        if (!sane) { cerr << "\n❌ Error: Truncated or malformed v4 container" << endl; return false; }
+
+        const unsigned char* master = masterKey(salt, fileKdf);
+        if (!master) return false;
+        unsigned char expectedKcv[KCV_SIZE], dataKey[DATA_KEY_SIZE];
+        computeKeyCheck(master + 32, prefix[4], salt, iv, expectedKcv);
+        if (!constant_time_compare(expectedKcv, kcv, KCV_SIZE)) { cerr << "\n❌ Wrong password" << endl; return false; }
+        if (!unwrapDataKey(master, prefix, wrap, dataKey)) {
+            cerr << "\n❌ Key unwrap failed - file tampered" << endl;
+            return false;
+        }
+        useKeys(dataKey);
+
+        unsigned long long nChunks = chunkCount(plainLen, chunkSize);
+        size_t tagLen = tagSize(fileSuite);
+        vector<unsigned char> tags(nChunks * tagLen);
+        for (unsigned long long i = 0; i < nChunks; i++) {
+            unsigned long long len = min(chunkSize, plainLen - i * chunkSize);
+            f.seekg(headerSize + i * (chunkSize + tagLen) + len, ios::beg);
+            f.read((char*)tags.data() + i * tagLen, tagLen);
+        }
+        if (!f) { secure_memzero(dataKey, DATA_KEY_SIZE); cerr << "\n❌ Error: Unexpected end of file" << endl; return false; }
+        unsigned char computed[HMAC_SIZE];
+        auto signHeader = [&](unsigned char out[HMAC_SIZE]) {
+            HeaderAuth auth(*this, fileSuite, iv);
+            auth.update(prefix, V4_PREFIX_SIZE);
+            auth.update(wrap, WRAP_SIZE);
+            auth.update(tags.data(), tags.size());
+            auth.update(ptHash, 32);
+            auth.final(out);
+        };
+        signHeader(computed);
+        if (!constant_time_compare(computed, headerTag, HMAC_SIZE)) {
+            secure_memzero(dataKey, DATA_KEY_SIZE);
+            cerr << "\n❌ Header authentication failed - file tampered" << endl;
+            return false;
+        }
+
+        // Same data key and IV; new master salt, KDF, key check and wrap, re-signed header
+        if (!target.sessionMasterSalt(salt)) { secure_memzero(dataKey, DATA_KEY_SIZE); return false; }
+        putKdfParams(prefix + V3_PREFIX_SIZE, target.kdfParams);
+        const unsigned char* newMaster = target.masterKey(salt, target.kdfParams);
+        if (!newMaster) { secure_memzero(dataKey, DATA_KEY_SIZE); return false; }
+        computeKeyCheck(newMaster + 32, prefix[4], salt, iv, kcv);
+        memcpy(wrap, dataKey, DATA_KEY_SIZE);
+        secure_memzero(dataKey, DATA_KEY_SIZE);
+        if (!wrapDataKey(newMaster, prefix, wrap)) return false;
+        signHeader(headerTag);
+
+        f.clear();
+        f.seekp(0, ios::beg);
+        f.write((char*)prefix, V4_PREFIX_SIZE);
+        f.write((char*)wrap, WRAP_SIZE);
+        f.write((char*)headerTag, HMAC_SIZE);
+        f.close();
+        if (f.fail() || !syncFile(file)) {
+            cerr << "\n❌ Error: Failed to rewrite header of '" << file << "'" << endl;
+            return false;
+        }
+        return true;
+    }
     string encryptText(const string& text) {
-        vector<unsigned char> data(text.begin(), text.end());
-        auto enc = encrypt(data);
-        return bytesToHex(enc.data(), enc.size());
+        vector<unsigned char> data(sealedSize(text.size()));
+        memcpy(data.data() + PAYLOAD_OFFSET, text.data(), text.size());
+        size_t sealed = encryptInPlace(data.data(), text.size());
+        return bytesToHex(data.data(), sealed);
     }
     string decryptText(const string& hexCipher) {
         auto data = hexToBytes(hexCipher);
-        auto dec = decrypt(data);
-        if (dec.empty()) return "";
-        return string(dec.begin(), dec.end());
+        size_t plainLen = 0;
+        if (!decryptInPlace(data.data(), data.size(), plainLen)) return "";
+        string text((const char*)data.data() + PAYLOAD_OFFSET, plainLen);
+        secure_memzero(data.data(), data.size());
+        return text;
     }
     void displayFileContent(const string& filename) {
         ifstream file(filename);
@@ -987,10 +2498,46 @@ public:
         cout << "📄 Lines:          " << lineCount << endl;
     }
     string hashFile(const string& filename) {
-        ifstream file(filename, ios::binary);
-        if (!file.is_open()) return "";
-        vector<unsigned char> data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
-        file.close();
-        return SHA256Impl::toHex(SHA256Impl::hash(data.data(), data.size()));
+        return hashFiles(vector<string>{filename})[0];
+    }
+    // Hash several files in lock-step through SHA256Impl::updateMany;
+    // unreadable files yield "" like hashFile()
+    vector<string> hashFiles(const vector<string>& filenames) {
+        vector<string> result(filenames.size());
+        const size_t CHUNK = 65536;
+        size_t lanes = max(SHA256Impl::multiLanes(), (size_t)1);
+        for (size_t base = 0; base < filenames.size(); base += lanes) {
+            size_t n = min(lanes, filenames.size() - base);
+            vector<unique_ptr<ifstream>> files(n);
+            vector<SHA256Impl::Hasher> hashers(n);
+            vector<SHA256Impl::Hasher*> hp(n);
+            vector<vector<unsigned char>> bufs(n, vector<unsigned char>(CHUNK));
+            vector<const unsigned char*> ptrs(n);
+            vector<size_t> lens(n);
+            for (size_t i = 0; i < n; i++) {
+                files[i].reset(new ifstream(filenames[base + i], ios::binary));
+                hp[i] = &hashers[i];
+                ptrs[i] = bufs[i].data();
+            }
+            bool more = true;
+            while (more) {
+                more = false;
+                for (size_t i = 0; i < n; i++) {
+                    lens[i] = 0;
+                    if (!files[i]->is_open() || files[i]->eof()) continue;
+                    files[i]->read((char*)bufs[i].data(), CHUNK);
+                    lens[i] = files[i]->gcount();
+                    more = more || lens[i] > 0;
+                }
+                SHA256Impl::updateMany(hp.data(), ptrs.data(), lens.data(), n);
+            }
+            vector<unsigned char> digests(n * 32);
+            SHA256Impl::finalMany(hp.data(), n, digests.data());
+            for (size_t i = 0; i < n; i++) {
+                if (!files[i]->is_open()) continue;
+                result[base + i] = SHA256Impl::toHex(vector<unsigned char>(digests.begin() + i*32, digests.begin() + i*32 + 32));
+            }
+        }
+        return result;
     }
 };
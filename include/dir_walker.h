@@ -0,0 +1,200 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════
+// Streaming Directory Walker
+// Lists every regular file under a root while the caller is
+// already consuming them. Several threads walk subdirectories in
+// parallel; on Linux each directory is read with getdents64 into
+// a 64 KB buffer, and subdirectories walked inline are opened
+// with openat relative to their parent. Memory stays bounded for
+// any tree size: the file queue blocks its producers at
+// `capacity` paths (back-pressure), and once MAX_PENDING_DIRS
+// directories are waiting, walkers descend into new ones inline
+// instead of queueing them. Symlinks are not followed.
+// Self-contained: Crypt-Vault.cpp includes it before FsCompat.
+// ═══════════════════════════════════════════════════════════
+#include <string>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+class DirWalker {
+public:
+    static const size_t MAX_PENDING_DIRS = 1024;
+    explicit DirWalker(const std::string& root, size_t threads = 0, size_t capacity = 4096)
+        : root(root), capacity(std::max((size_t)1, capacity)) {
+        if (threads == 0) threads = std::min(8u, std::max(1u, std::thread::hardware_concurrency()));
+        dirs.push_back(root);
+        for (size_t i = 0; i < threads; i++) pool.emplace_back([this] { walk(); });
+    }
+    DirWalker(const DirWalker&) = delete;
+    DirWalker& operator=(const DirWalker&) = delete;
+    ~DirWalker() {
+        {
+            std::lock_guard<std::mutex> g(m);
+            stopping = true;
+        }
+        wakeAll();
+        for (auto& t : pool) t.join();
+    }
+    // Next file path; false once the whole tree has been listed
+    bool next(std::string& path) {
+        std::unique_lock<std::mutex> g(m);
+        filesReady.wait(g, [&] { return !files.empty() || finished(); });
+        if (files.empty()) return false;
+        path = std::move(files.front());
+        files.pop_front();
+        if (files.size() + 1 == capacity) space.notify_all();
+        return true;
+    }
+    // Directories that could not be opened or read
+    size_t errors() const { return failed.load(); }
+
+private:
+    std::mutex m;
+    std::condition_variable filesReady, space, dirsReady;
+    std::deque<std::string> files, dirs;
+    std::vector<std::thread> pool;
+    std::string root;
+    size_t capacity, busy = 0;
+    std::atomic<bool> stopping{false};   // set under m; also polled unlocked by list()
+    std::atomic<size_t> failed{0};
+
+    bool finished() const { return stopping || (dirs.empty() && busy == 0); }
+    void wakeAll() {
+        filesReady.notify_all();
+        space.notify_all();
+        dirsReady.notify_all();
+    }
+
+    // Hand one file to the consumer, waiting while the queue is full
+    bool emit(std::string path) {
+        std::unique_lock<std::mutex> g(m);
+        space.wait(g, [&] { return stopping || files.size() < capacity; });
+        if (stopping) return false;
+        files.push_back(std::move(path));
+        if (files.size() == 1) filesReady.notify_all();
+        return true;
+    }
+    // Queue a subdirectory for any walker; false when the queue is full.
+    // Once stopping, the directory is dropped and reported as handled.
+    bool share(const std::string& dir) {
+        std::lock_guard<std::mutex> g(m);
+        if (stopping) return true;
+        if (dirs.size() >= MAX_PENDING_DIRS) return false;
+        dirs.push_back(dir);
+        dirsReady.notify_one();
+        return true;
+    }
+    void walk() {
+        for (;;) {
+            std::string dir;
+            {
+                std::unique_lock<std::mutex> g(m);
+                dirsReady.wait(g, [&] { return !dirs.empty() || finished(); });
+                if (stopping || dirs.empty()) return;
+                dir = std::move(dirs.back());   // depth-first keeps the queue short
+                dirs.pop_back();
+                busy++;
+            }
+#ifdef _WIN32
+            list(dir);
+#else
+            list(dir, AT_FDCWD, dir.c_str());
+#endif
+            std::lock_guard<std::mutex> g(m);
+            if (--busy == 0 && dirs.empty()) wakeAll();   // the walk is complete
+        }
+    }
+
+#ifdef _WIN32
+    void list(const std::string& dir) {
+        WIN32_FIND_DATAA fd;
+        HANDLE h = ::FindFirstFileA((dir + "\\*").c_str(), &fd);
+        if (h == INVALID_HANDLE_VALUE) { failed++; return; }
+        bool more = true;
+        do {
+            if (stopping) break;
+            std::string name = fd.cFileName;
+            if (name == "." || name == "..") continue;
+            std::string path = dir + "\\" + name;
+            if (fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) continue;
+            if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                if (!share(path)) list(path);
+            } else {
+                more = emit(path);
+            }
+        } while (more && ::FindNextFileA(h, &fd));
+        ::FindClose(h);
+    }
+#else
+    // Walk `dir` (opened as `name` relative to `parentFd`); subdirectories
+    // go to the shared queue, or are walked right here when it is full
+    void list(const std::string& dir, int parentFd, const char* name) {
+        int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC | (dir == root ? 0 : O_NOFOLLOW);   // the root may be a link
+        int fd = ::openat(parentFd, name, flags);
+        if (fd < 0) { failed++; return; }
+        bool more = true;
+        auto entry = [&](const char* entryName, unsigned char type) {
+            if (stopping) { more = false; return; }
+            if (entryName[0] == '.' && (entryName[1] == 0 || (entryName[1] == '.' && entryName[2] == 0))) return;
+            if (type == DT_UNKNOWN) {
+                struct stat st;
+                if (::fstatat(fd, entryName, &st, AT_SYMLINK_NOFOLLOW) != 0) return;
+                type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_LNK;
+            }
+            std::string path = dir + "/" + entryName;
+            if (type == DT_DIR) {
+                if (!share(path)) list(path, fd, entryName);
+            } else if (type == DT_REG) {
+                more = emit(std::move(path));
+            }
+        };
+#ifdef __linux__
+        struct LinuxDirent64 {
+            unsigned long long d_ino;
+            long long d_off;
+            unsigned short d_reclen;
+            unsigned char d_type;
+            char d_name[1];
+        };
+        std::vector<char> buf(64 * 1024);
+        while (more && !stopping) {
+            long n = ::syscall(SYS_getdents64, fd, buf.data(), buf.size());
+            if (n < 0) { failed++; break; }
+            if (n == 0) break;
+            for (long off = 0; more && off < n; ) {
+                const LinuxDirent64* d = (const LinuxDirent64*)(buf.data() + off);
+                entry(d->d_name, d->d_type);
+                off += d->d_reclen;
+            }
+        }
+        ::close(fd);
+#else
+        DIR* d = ::fdopendir(fd);
+        if (!d) { ::close(fd); failed++; return; }
+        while (more && !stopping) {
+            struct dirent* e = ::readdir(d);
+            if (!e) break;
+            entry(e->d_name, e->d_type);
+        }
+        ::closedir(d);
+#endif
+    }
+#endif
+};
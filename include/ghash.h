@@ -0,0 +1,154 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════
+// GHASH (GF(2^128) universal hash of AES-GCM, NIST SP 800-38D)
+// PCLMULQDQ kernel with a constant-time portable fallback.
+// State and key are kept in the spec's big-endian byte order.
+// ═══════════════════════════════════════════════════════════
+#include <cstring>
+#include <cstddef>
+#include "cpu_features.h"
+#ifdef CRYPTVAULT_X86
+#include <immintrin.h>
+#endif
+
+namespace GHASHImpl {
+    typedef unsigned long long uint64;
+
+    inline uint64 load64be(const unsigned char* p) {
+        uint64 v = 0;
+        for (int i = 0; i < 8; i++) v = (v << 8) | p[i];
+        return v;
+    }
+    inline void store64be(unsigned char* p, uint64 v) {
+        for (int i = 7; i >= 0; i--) { p[i] = (unsigned char)v; v >>= 8; }
+    }
+
+    // Bit-serial multiply with masks instead of branches or tables
+    inline void blocksPortable(const unsigned char h[16], unsigned char y[16],
+                               const unsigned char* data, size_t nBlocks) {
+        uint64 hh = load64be(h), hl = load64be(h + 8);
+        uint64 yh = load64be(y), yl = load64be(y + 8);
+        for (size_t b = 0; b < nBlocks; b++) {
+            uint64 x[2] = {yh ^ load64be(data + b*16), yl ^ load64be(data + b*16 + 8)};
+            uint64 zh = 0, zl = 0, vh = hh, vl = hl;
+            for (int w = 0; w < 2; w++) {
+                for (int i = 63; i >= 0; i--) {
+                    uint64 m = 0 - ((x[w] >> i) & 1);
+                    zh ^= vh & m; zl ^= vl & m;
+                    uint64 r = 0 - (vl & 1);
+                    vl = (vl >> 1) | (vh << 63);
+                    vh = (vh >> 1) ^ (0xe100000000000000ULL & r);
+                }
+            }
+            yh = zh; yl = zl;
+        }
+        store64be(y, yh); store64be(y + 8, yl);
+    }
+
+#ifdef CRYPTVAULT_X86
+    // Carry-less multiply of byte-reflected operands, then shift-left-by-one
+    // and reduction modulo x^128 + x^7 + x^2 + x + 1 (Intel GCM white paper)
+    CV_TARGET("pclmul,sse2")
+    inline __m128i gfmul(__m128i a, __m128i b) {
+        __m128i t3 = _mm_clmulepi64_si128(a, b, 0x00);
+        __m128i t4 = _mm_clmulepi64_si128(a, b, 0x10);
+        __m128i t5 = _mm_clmulepi64_si128(a, b, 0x01);
+        __m128i t6 = _mm_clmulepi64_si128(a, b, 0x11);
+        t4 = _mm_xor_si128(t4, t5);
+        t5 = _mm_slli_si128(t4, 8);
+        t4 = _mm_srli_si128(t4, 8);
+        t3 = _mm_xor_si128(t3, t5);
+        t6 = _mm_xor_si128(t6, t4);
+        __m128i t7 = _mm_srli_epi32(t3, 31);
+        __m128i t8 = _mm_srli_epi32(t6, 31);
+        t3 = _mm_slli_epi32(t3, 1);
+        t6 = _mm_slli_epi32(t6, 1);
+        __m128i t9 = _mm_srli_si128(t7, 12);
+        t8 = _mm_slli_si128(t8, 4);
+        t7 = _mm_slli_si128(t7, 4);
+        t3 = _mm_or_si128(t3, t7);
+        t6 = _mm_or_si128(t6, t8);
+        t6 = _mm_or_si128(t6, t9);
+        t7 = _mm_slli_epi32(t3, 31);
+        t8 = _mm_slli_epi32(t3, 30);
+        t9 = _mm_slli_epi32(t3, 25);
+        t7 = _mm_xor_si128(_mm_xor_si128(t7, t8), t9);
+        t8 = _mm_srli_si128(t7, 4);
+        t7 = _mm_slli_si128(t7, 12);
+        t3 = _mm_xor_si128(t3, t7);
+        __m128i t2 = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(t3, 1), _mm_srli_epi32(t3, 2)),
+                                   _mm_srli_epi32(t3, 7));
+        t2 = _mm_xor_si128(t2, t8);
+        t3 = _mm_xor_si128(t3, t2);
+        return _mm_xor_si128(t6, t3);
+    }
+
+    CV_TARGET("pclmul,ssse3")
+    inline void blocksClmul(const unsigned char h[16], unsigned char y[16],
+                            const unsigned char* data, size_t nBlocks) {
+        const __m128i bswap = _mm_set_epi8(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15);
+        __m128i hk = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)h), bswap);
+        __m128i acc = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)y), bswap);
+        for (size_t b = 0; b < nBlocks; b++) {
+            __m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + b*16)), bswap);
+            acc = gfmul(_mm_xor_si128(acc, x), hk);
+        }
+        _mm_storeu_si128((__m128i*)y, _mm_shuffle_epi8(acc, bswap));
+    }
+#endif
+
+    inline bool clmulAvailable() {
+        const auto& f = CpuFeatures::get();
+        return f.pclmul && f.ssse3;
+    }
+
+    // y = (y ^ X1) * H, ... over whole 16-byte blocks
+    inline void blocks(const unsigned char h[16], unsigned char y[16], const unsigned char* data, size_t nBlocks) {
+#ifdef CRYPTVAULT_X86
+        if (clmulAvailable()) { blocksClmul(h, y, data, nBlocks); return; }
+#endif
+        blocksPortable(h, y, data, nBlocks);
+    }
+
+    // Streaming GHASH over A || pad || C || pad || len(A) || len(C)
+    class Hasher {
+        unsigned char h[16], y[16], buffer[16];
+        size_t bufferLen;
+    public:
+        explicit Hasher(const unsigned char key[16]) : bufferLen(0) {
+            memcpy(h, key, 16);
+            memset(y, 0, 16);
+        }
+        ~Hasher() { memset(h, 0, 16); }
+        void update(const unsigned char* data, size_t len) {
+            if (bufferLen > 0) {
+                size_t take = len < 16 - bufferLen ? len : 16 - bufferLen;
+                memcpy(buffer + bufferLen, data, take);
+                bufferLen += take; data += take; len -= take;
+                if (bufferLen < 16) return;
+                blocks(h, y, buffer, 1);
+                bufferLen = 0;
+            }
+            size_t whole = len / 16;
+            if (whole > 0) blocks(h, y, data, whole);
+            data += whole * 16; len -= whole * 16;
+            memcpy(buffer, data, len);
+            bufferLen = len;
+        }
+        // Zero-pad the current partial block (end of AAD or ciphertext)
+        void pad() {
+            if (bufferLen == 0) return;
+            memset(buffer + bufferLen, 0, 16 - bufferLen);
+            blocks(h, y, buffer, 1);
+            bufferLen = 0;
+        }
+        void final(uint64 aadBytes, uint64 ctBytes, unsigned char out[16]) {
+            pad();
+            unsigned char lens[16];
+            store64be(lens, aadBytes * 8);
+            store64be(lens + 8, ctBytes * 8);
+            blocks(h, y, lens, 1);
+            memcpy(out, y, 16);
+        }
+    };
+}
@@ -96,11 +96,17 @@ inline void saveIdentity(const NodeIdentity& id, const string& password) {
                         "PUBLIC_KEY:" + id.publicKey + "\n" +
                         "PRIVATE_KEY:" + id.privateKey + "\n" +
                         "DISPLAY_NAME:" + id.displayName + "\n";
-    vector<unsigned char> plaintext(serialized.begin(), serialized.end());
-    
+    vector<unsigned char> encrypted(AESCipher::sealedSize(serialized.size()));
+    memcpy(encrypted.data() + AESCipher::PAYLOAD_OFFSET, serialized.data(), serialized.size());
+    secure_memzero(&serialized[0], serialized.size());
+
     AESCipher cipher;
     cipher.setKey(password);
-    vector<unsigned char> encrypted = cipher.encrypt(plaintext);
+    encrypted.resize(cipher.encryptInPlace(encrypted.data(), serialized.size()));
+    if (encrypted.empty()) {
+        cerr << "  [ID] WARNING: Cannot encrypt identity" << endl;
+        return;
+    }
 
     ofstream f(IDENTITY_FILE, ios::binary);
     if (!f.is_open()) {
@@ -147,12 +153,13 @@ inline bool loadIdentity(NodeIdentity& id, const string& password) {
 
     AESCipher cipher;
     cipher.setKey(password);
-    vector<unsigned char> plaintext = cipher.decrypt(encrypted);
-    if (plaintext.empty()) {
+    size_t plainLen = 0;
+    if (!cipher.decryptInPlace(encrypted.data(), encrypted.size(), plainLen) || plainLen == 0) {
         cerr << "  [ID] ERROR: Incorrect password for identity.key!" << endl;
         return false;
     }
-    string data(plaintext.begin(), plaintext.end());
+    string data((const char*)encrypted.data() + AESCipher::PAYLOAD_OFFSET, plainLen);
+    secure_memzero(encrypted.data(), encrypted.size());
 
     stringstream ss(data);
     string line;
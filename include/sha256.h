@@ -0,0 +1,463 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════
+// SHA-256 Implementation
+// Shared by crypto_utils.h and the blockchain audit log.
+// Compression backends: portable scalar, AVX2 message schedule
+// (two blocks per pass), and Intel SHA extensions, chosen at runtime.
+// ═══════════════════════════════════════════════════════════
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include "cpu_features.h"
+#ifdef CRYPTVAULT_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace SHA256Impl {
+    typedef unsigned int uint32;
+    typedef unsigned long long uint64;
+    static const uint32 K[64] = {
+        0x428a2f98,0x71374491,0xb5c0fbcf,0xe9b5dba5,0x3956c25b,0x59f111f1,0x923f82a4,0xab1c5ed5,
+        0xd807aa98,0x12835b01,0x243185be,0x550c7dc3,0x72be5d74,0x80deb1fe,0x9bdc06a7,0xc19bf174,
+        0xe49b69c1,0xefbe4786,0x0fc19dc6,0x240ca1cc,0x2de92c6f,0x4a7484aa,0x5cb0a9dc,0x76f988da,
+        0x983e5152,0xa831c66d,0xb00327c8,0xbf597fc7,0xc6e00bf3,0xd5a79147,0x06ca6351,0x14292967,
+        0x27b70a85,0x2e1b2138,0x4d2c6dfc,0x53380d13,0x650a7354,0x766a0abb,0x81c2c92e,0x92722c85,
+        0xa2bfe8a1,0xa81a664b,0xc24b8b70,0xc76c51a3,0xd192e819,0xd6990624,0xf40e3585,0x106aa070,
+        0x19a4c116,0x1e376c08,0x2748774c,0x34b0bcb5,0x391c0cb3,0x4ed8aa4a,0x5b9cca4f,0x682e6ff3,
+        0x748f82ee,0x78a5636f,0x84c87814,0x8cc70208,0x90befffa,0xa4506ceb,0xbef9a3f7,0xc67178f2
+    };
+    inline uint32 rotr(uint32 x, int n) { return (x >> n) | (x << (32 - n)); }
+    inline uint32 ch(uint32 x, uint32 y, uint32 z) { return (x & y) ^ (~x & z); }
+    inline uint32 maj(uint32 x, uint32 y, uint32 z) { return (x & y) ^ (x & z) ^ (y & z); }
+    inline uint32 sig0(uint32 x) { return rotr(x, 2) ^ rotr(x, 13) ^ rotr(x, 22); }
+    inline uint32 sig1(uint32 x) { return rotr(x, 6) ^ rotr(x, 11) ^ rotr(x, 25); }
+    inline uint32 gam0(uint32 x) { return rotr(x, 7) ^ rotr(x, 18) ^ (x >> 3); }
+    inline uint32 gam1(uint32 x) { return rotr(x, 17) ^ rotr(x, 19) ^ (x >> 10); }
+
+    // 64 rounds over a precomputed W[i] + K[i] schedule
+    inline void rounds(uint32 states[8], const uint32 wk[64]) {
+        uint32 a=states[0],b1=states[1],c=states[2],d=states[3],e=states[4],f=states[5],g=states[6],hh=states[7];
+        for (int i = 0; i < 64; i++) {
+            uint32 t1 = hh + sig1(e) + ch(e,f,g) + wk[i];
+            uint32 t2 = sig0(a) + maj(a,b1,c);
+            hh=g; g=f; f=e; e=d+t1; d=c; c=b1; b1=a; a=t1+t2;
+        }
+        states[0]+=a;states[1]+=b1;states[2]+=c;states[3]+=d;states[4]+=e;states[5]+=f;states[6]+=g;states[7]+=hh;
+    }
+
+    inline void compressScalar(uint32 states[8], const unsigned char* data, size_t nBlocks) {
+        for (; nBlocks > 0; nBlocks--, data += 64) {
+            uint32 w[64];
+            for (int i = 0; i < 16; i++)
+                w[i] = ((uint32)data[i*4]<<24)|((uint32)data[i*4+1]<<16)|((uint32)data[i*4+2]<<8)|data[i*4+3];
+            for (int i = 16; i < 64; i++)
+                w[i] = gam1(w[i-2]) + w[i-7] + gam0(w[i-15]) + w[i-16];
+            for (int i = 0; i < 64; i++) w[i] += K[i];
+            rounds(states, w);
+        }
+    }
+
+#ifdef CRYPTVAULT_X86
+    // Intel SHA extensions: state kept as ABEF/CDGH, 4 rounds per step
+    CV_TARGET("sha,sse4.1")
+    inline void compressShaNi(uint32 states[8], const unsigned char* data, size_t nBlocks) {
+        const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+        __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)states), 0xB1);        // CDAB
+        __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(states + 4)), 0x1B); // EFGH
+        __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);     // ABEF
+        state1 = _mm_blend_epi16(state1, tmp, 0xF0);          // CDGH
+        for (; nBlocks > 0; nBlocks--, data += 64) {
+            __m128i abefSave = state0, cdghSave = state1;
+            __m128i msg[4];
+            for (int j = 0; j < 4; j++)
+                msg[j] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + j*16)), bswap);
+            for (int i = 0; i < 16; i++) {
+                __m128i wk = _mm_add_epi32(msg[i & 3], _mm_loadu_si128((const __m128i*)(K + i*4)));
+                state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+                state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(wk, 0x0E));
+                if (i < 12) {
+                    __m128i t = _mm_sha256msg1_epu32(msg[i & 3], msg[(i+1) & 3]);
+                    t = _mm_add_epi32(t, _mm_alignr_epi8(msg[(i+3) & 3], msg[(i+2) & 3], 4));
+                    msg[i & 3] = _mm_sha256msg2_epu32(t, msg[(i+3) & 3]);
+                }
+            }
+            state0 = _mm_add_epi32(state0, abefSave);
+            state1 = _mm_add_epi32(state1, cdghSave);
+        }
+        tmp = _mm_shuffle_epi32(state0, 0x1B);                // FEBA
+        state1 = _mm_shuffle_epi32(state1, 0xB1);             // DCHG
+        _mm_storeu_si128((__m128i*)states, _mm_blend_epi16(tmp, state1, 0xF0));          // DCBA
+        _mm_storeu_si128((__m128i*)(states + 4), _mm_alignr_epi8(state1, tmp, 8));       // HGFE
+    }
+
+    // Two independent single-block compressions interleaved so the SHA
+    // units overlap (dependent chains such as PBKDF2's two output blocks)
+    CV_TARGET("sha,sse4.1")
+    inline void compressShaNiX2(uint32* statesA, const unsigned char* blockA,
+                                uint32* statesB, const unsigned char* blockB) {
+        const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+        uint32* states[2] = {statesA, statesB};
+        const unsigned char* blocks[2] = {blockA, blockB};
+        __m128i s0[2], s1[2], save0[2], save1[2], msg[2][4];
+        for (int k = 0; k < 2; k++) {
+            __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)states[k]), 0xB1);
+            s1[k] = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(states[k] + 4)), 0x1B);
+            s0[k] = _mm_alignr_epi8(tmp, s1[k], 8);
+            s1[k] = _mm_blend_epi16(s1[k], tmp, 0xF0);
+            save0[k] = s0[k]; save1[k] = s1[k];
+            for (int j = 0; j < 4; j++)
+                msg[k][j] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks[k] + j*16)), bswap);
+        }
+        for (int i = 0; i < 16; i++) {
+            __m128i kv = _mm_loadu_si128((const __m128i*)(K + i*4));
+            for (int k = 0; k < 2; k++) {
+                __m128i wk = _mm_add_epi32(msg[k][i & 3], kv);
+                s1[k] = _mm_sha256rnds2_epu32(s1[k], s0[k], wk);
+                s0[k] = _mm_sha256rnds2_epu32(s0[k], s1[k], _mm_shuffle_epi32(wk, 0x0E));
+                if (i < 12) {
+                    __m128i t = _mm_sha256msg1_epu32(msg[k][i & 3], msg[k][(i+1) & 3]);
+                    t = _mm_add_epi32(t, _mm_alignr_epi8(msg[k][(i+3) & 3], msg[k][(i+2) & 3], 4));
+                    msg[k][i & 3] = _mm_sha256msg2_epu32(t, msg[k][(i+3) & 3]);
+                }
+            }
+        }
+        for (int k = 0; k < 2; k++) {
+            __m128i tmp = _mm_shuffle_epi32(_mm_add_epi32(s0[k], save0[k]), 0x1B);
+            __m128i t1 = _mm_shuffle_epi32(_mm_add_epi32(s1[k], save1[k]), 0xB1);
+            _mm_storeu_si128((__m128i*)states[k], _mm_blend_epi16(tmp, t1, 0xF0));
+            _mm_storeu_si128((__m128i*)(states[k] + 4), _mm_alignr_epi8(t1, tmp, 8));
+        }
+    }
+
+    CV_TARGET("avx2")
+    inline __m256i rotr256(__m256i x, int n) {
+        return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+    }
+
+    // AVX2: message schedule for two blocks at once (one per 128-bit lane),
+    // rounds stay scalar
+    CV_TARGET("avx2")
+    inline void compressAvx2(uint32 states[8], const unsigned char* data, size_t nBlocks) {
+        const __m256i bswap = _mm256_broadcastsi128_si256(
+            _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL));
+        const __m256i zero = _mm256_setzero_si256();
+        uint32 wk[2][64];
+        while (nBlocks > 0) {
+            const unsigned char* second = nBlocks > 1 ? data + 64 : data;
+            __m256i x[4];
+            for (int j = 0; j < 4; j++) {
+                __m256i v = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(data + j*16)));
+                v = _mm256_inserti128_si256(v, _mm_loadu_si128((const __m128i*)(second + j*16)), 1);
+                x[j] = _mm256_shuffle_epi8(v, bswap);
+            }
+            for (int i = 0; i < 16; i++) {
+                __m256i k = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(K + i*4)));
+                __m256i v = _mm256_add_epi32(x[i & 3], k);
+                _mm_storeu_si128((__m128i*)(wk[0] + i*4), _mm256_castsi256_si128(v));
+                _mm_storeu_si128((__m128i*)(wk[1] + i*4), _mm256_extracti128_si256(v, 1));
+                if (i >= 12) continue;
+                __m256i x0 = x[i & 3], x1 = x[(i+1) & 3], x2 = x[(i+2) & 3], x3 = x[(i+3) & 3];
+                __m256i w15 = _mm256_alignr_epi8(x1, x0, 4);     // W[t-15..t-12]
+                __m256i w7  = _mm256_alignr_epi8(x3, x2, 4);     // W[t-7..t-4]
+                __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr256(w15, 7), rotr256(w15, 18)),
+                                              _mm256_srli_epi32(w15, 3));
+                __m256i t = _mm256_add_epi32(_mm256_add_epi32(x0, s0), w7);
+                // gamma1 needs W[t-2], W[t-1] for lanes 0-1, then the fresh W[t], W[t+1] for lanes 2-3
+                __m256i lo = _mm256_shuffle_epi32(x3, 0xFE);
+                lo = _mm256_xor_si256(_mm256_xor_si256(rotr256(lo, 17), rotr256(lo, 19)), _mm256_srli_epi32(lo, 10));
+                t = _mm256_add_epi32(t, _mm256_blend_epi32(lo, zero, 0xCC));
+                __m256i hi = _mm256_shuffle_epi32(t, 0x40);
+                hi = _mm256_xor_si256(_mm256_xor_si256(rotr256(hi, 17), rotr256(hi, 19)), _mm256_srli_epi32(hi, 10));
+                x[i & 3] = _mm256_add_epi32(t, _mm256_blend_epi32(zero, hi, 0xCC));
+            }
+            rounds(states, wk[0]);
+            if (nBlocks > 1) rounds(states, wk[1]);
+            size_t done = nBlocks > 1 ? 2 : 1;
+            data += done * 64;
+            nBlocks -= done;
+        }
+    }
+#endif
+
+#if defined(CRYPTVAULT_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CRYPTVAULT_SHA_MULTIBUFFER 1
+    // Multi-buffer: one independent stream per vector lane (4 on SSE2, 8 on AVX2)
+    typedef uint32 LaneVec4 __attribute__((vector_size(16)));
+    typedef uint32 LaneVec8 __attribute__((vector_size(32)));
+
+    template <class V, int L>
+    __attribute__((always_inline)) inline void compressVertical(uint32* const* states,
+                                                                const unsigned char* const* blocks, size_t n) {
+        #define CV_LROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+        V w[16], st[8];
+        for (int i = 0; i < 16; i++)
+            for (int l = 0; l < L; l++) {
+                const unsigned char* p = blocks[(size_t)l < n ? l : 0] + i*4;
+                w[i][l] = ((uint32)p[0]<<24)|((uint32)p[1]<<16)|((uint32)p[2]<<8)|p[3];
+            }
+        for (int j = 0; j < 8; j++)
+            for (int l = 0; l < L; l++) st[j][l] = states[(size_t)l < n ? l : 0][j];
+        V a=st[0],b=st[1],c=st[2],d=st[3],e=st[4],f=st[5],g=st[6],hh=st[7];
+        for (int i = 0; i < 64; i++) {
+            if (i >= 16) {
+                V w2 = w[(i-2) & 15], w15 = w[(i-15) & 15];
+                w[i & 15] += (CV_LROTR(w2, 17) ^ CV_LROTR(w2, 19) ^ (w2 >> 10)) + w[(i-7) & 15]
+                           + (CV_LROTR(w15, 7) ^ CV_LROTR(w15, 18) ^ (w15 >> 3));
+            }
+            V t1 = hh + (CV_LROTR(e, 6) ^ CV_LROTR(e, 11) ^ CV_LROTR(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i & 15];
+            V t2 = (CV_LROTR(a, 2) ^ CV_LROTR(a, 13) ^ CV_LROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            hh=g; g=f; f=e; e=d+t1; d=c; c=b; b=a; a=t1+t2;
+        }
+        st[0]+=a;st[1]+=b;st[2]+=c;st[3]+=d;st[4]+=e;st[5]+=f;st[6]+=g;st[7]+=hh;
+        for (size_t l = 0; l < n; l++)
+            for (int j = 0; j < 8; j++) states[l][j] = st[j][l];
+        #undef CV_LROTR
+    }
+    inline void compressLanes4(uint32* const* states, const unsigned char* const* blocks, size_t n) {
+        compressVertical<LaneVec4, 4>(states, blocks, n);
+    }
+    CV_TARGET("avx2")
+    inline void compressLanes8(uint32* const* states, const unsigned char* const* blocks, size_t n) {
+        compressVertical<LaneVec8, 8>(states, blocks, n);
+    }
+#endif
+
+    enum class Backend { Scalar, Avx2, ShaNi };
+    // Falls back when the CPU lacks the requested extension
+    inline Backend usable(Backend b) {
+        const CpuFeatures::Flags& cpu = CpuFeatures::get();
+        if (b == Backend::ShaNi && !(cpu.shani && cpu.sse41)) b = Backend::Avx2;
+        if (b == Backend::Avx2 && !cpu.avx2) b = Backend::Scalar;
+        return b;
+    }
+    // CRYPTVAULT_SHA_BACKEND=scalar|avx2|shani overrides detection
+    inline Backend bestBackend() {
+        static const Backend chosen = [] {
+            const char* env = getenv("CRYPTVAULT_SHA_BACKEND");
+            string want = env ? env : "";
+            if (want == "scalar") return Backend::Scalar;
+            if (want == "avx2") return usable(Backend::Avx2);
+            return usable(Backend::ShaNi);
+        }();
+        return chosen;
+    }
+    inline const char* backendName(Backend b) {
+        switch (b) {
+            case Backend::ShaNi: return "SHA-NI";
+            case Backend::Avx2:  return "AVX2";
+            default:             return "Scalar";
+        }
+    }
+    inline void compressBlocks(Backend backend, uint32 states[8], const unsigned char* data, size_t nBlocks) {
+#ifdef CRYPTVAULT_X86
+        if (backend == Backend::ShaNi) { compressShaNi(states, data, nBlocks); return; }
+        if (backend == Backend::Avx2) { compressAvx2(states, data, nBlocks); return; }
+#endif
+        (void)backend;
+        compressScalar(states, data, nBlocks);
+    }
+
+    // Streams advanced together by updateMany(). SHA-NI beats vertical SIMD
+    // per stream, so with it (or without SIMD) streams run one after another.
+    inline size_t multiLanes() {
+#ifdef CRYPTVAULT_SHA_MULTIBUFFER
+        if (bestBackend() == Backend::ShaNi) return 1;
+        if (bestBackend() == Backend::Avx2) return 8;
+        if (CpuFeatures::get().sse2) return 4;
+#endif
+        return 1;
+    }
+    // One block per stream, n <= lanes
+    inline void compressLanes(size_t lanes, uint32* const* states, const unsigned char* const* blocks, size_t n) {
+#ifdef CRYPTVAULT_SHA_MULTIBUFFER
+        if (lanes == 8 && n > 4) { compressLanes8(states, blocks, n); return; }
+        if (lanes >= 4) { compressLanes4(states, blocks, n); return; }
+#endif
+        (void)lanes;
+        for (size_t l = 0; l < n; l++) compressBlocks(bestBackend(), states[l], blocks[l], 1);
+    }
+
+    // One block for each of n independent streams, any n: SHA-NI streams go
+    // two at a time through the interleaved kernel, otherwise SIMD lanes
+    inline void compressMany(uint32* const* states, const unsigned char* const* blocks, size_t n) {
+#ifdef CRYPTVAULT_X86
+        if (bestBackend() == Backend::ShaNi) {
+            size_t i = 0;
+            for (; i + 2 <= n; i += 2) compressShaNiX2(states[i], blocks[i], states[i+1], blocks[i+1]);
+            if (i < n) compressShaNi(states[i], blocks[i], 1);
+            return;
+        }
+#endif
+        size_t lanes = multiLanes();
+        for (size_t i = 0; i < n; i += lanes)
+            compressLanes(lanes, states + i, blocks + i, min(lanes, n - i));
+    }
+    static const uint32 IV[8] = {
+        0x6a09e667,0xbb67ae85,0x3c6ef372,0xa54ff53a,0x510e527f,0x9b05688c,0x1f83d9ab,0x5be0cd19
+    };
+
+    class Hasher {
+        friend void updateMany(Hasher* const*, const unsigned char* const*, const size_t*, size_t);
+        friend void finalMany(Hasher* const*, size_t, unsigned char*);
+        uint32 states[8];
+        unsigned char buffer[64];
+        uint64 bitlen;
+        size_t bufferLen;
+        Backend backend;
+    public:
+        Hasher() : backend(bestBackend()) { reset(); }
+        explicit Hasher(Backend b) : backend(usable(b)) { reset(); }
+        // Continue from a midstate reached after prefixBlocks whole blocks
+        Hasher(const uint32 midstate[8], uint64 prefixBlocks) : backend(bestBackend()) {
+            memcpy(states, midstate, sizeof(states));
+            bitlen = prefixBlocks * 512; bufferLen = 0;
+        }
+        void reset() {
+            memcpy(states, IV, sizeof(states));
+            bitlen = 0; bufferLen = 0;
+        }
+        // Whole blocks are compressed straight from the caller's buffer
+        void update(const unsigned char* data, size_t len) {
+            if (bufferLen > 0) {
+                size_t take = min(len, 64 - bufferLen);
+                memcpy(buffer + bufferLen, data, take);
+                bufferLen += take; data += take; len -= take;
+                if (bufferLen < 64) return;
+                compressBlocks(backend, states, buffer, 1);
+                bitlen += 512;
+                bufferLen = 0;
+            }
+            size_t nBlocks = len / 64;
+            if (nBlocks > 0) {
+                compressBlocks(backend, states, data, nBlocks);
+                bitlen += (uint64)nBlocks * 512;
+                data += nBlocks * 64; len -= nBlocks * 64;
+            }
+            memcpy(buffer, data, len);
+            bufferLen = len;
+        }
+        vector<unsigned char> final() {
+            uint64 totalBitLen = bitlen + bufferLen * 8;
+            buffer[bufferLen++] = 0x80;
+            if (bufferLen > 56) {
+                while (bufferLen < 64) buffer[bufferLen++] = 0x00;
+                compressBlocks(backend, states, buffer, 1);
+                bufferLen = 0;
+            }
+            while (bufferLen < 56) buffer[bufferLen++] = 0x00;
+            for (int i = 7; i >= 0; i--) buffer[56 + (7 - i)] = (unsigned char)(totalBitLen >> (i * 8));
+            compressBlocks(backend, states, buffer, 1);
+            vector<unsigned char> res(32);
+            for (int i = 0; i < 8; i++) {
+                res[i*4]=(states[i]>>24)&0xff; res[i*4+1]=(states[i]>>16)&0xff;
+                res[i*4+2]=(states[i]>>8)&0xff; res[i*4+3]=states[i]&0xff;
+            }
+            return res;
+        }
+    };
+
+    // Advance n independent streams; stream i absorbs data[i][0..lens[i])
+    inline void updateMany(Hasher* const* hs, const unsigned char* const* data, const size_t* lens, size_t n) {
+        size_t lanes = multiLanes();
+        if (lanes == 1) {
+            for (size_t i = 0; i < n; i++) hs[i]->update(data[i], lens[i]);
+            return;
+        }
+        for (size_t base = 0; base < n; base += lanes) {
+            size_t group = min(lanes, n - base);
+            const unsigned char* pos[8];
+            size_t rem[8];
+            bool pending[8];   // buffer holds a full block to compress first
+            for (size_t l = 0; l < group; l++) {
+                Hasher& h = *hs[base + l];
+                pos[l] = data[base + l]; rem[l] = lens[base + l]; pending[l] = false;
+                if (h.bufferLen > 0) {
+                    size_t take = min(rem[l], 64 - h.bufferLen);
+                    memcpy(h.buffer + h.bufferLen, pos[l], take);
+                    h.bufferLen += take; pos[l] += take; rem[l] -= take;
+                    pending[l] = h.bufferLen == 64;
+                }
+            }
+            for (;;) {
+                uint32* st[8];
+                const unsigned char* blk[8];
+                size_t active = 0;
+                for (size_t l = 0; l < group; l++) {
+                    Hasher& h = *hs[base + l];
+                    if (pending[l]) {
+                        blk[active] = h.buffer; pending[l] = false; h.bufferLen = 0;
+                    } else if (h.bufferLen == 0 && rem[l] >= 64) {
+                        blk[active] = pos[l]; pos[l] += 64; rem[l] -= 64;
+                    } else continue;
+                    st[active++] = h.states;
+                    h.bitlen += 512;
+                }
+                if (active == 0) break;
+                compressLanes(lanes, st, blk, active);
+            }
+            for (size_t l = 0; l < group; l++) {
+                Hasher& h = *hs[base + l];
+                memcpy(h.buffer + h.bufferLen, pos[l], rem[l]);
+                h.bufferLen += rem[l];
+            }
+        }
+    }
+    // Pad and finish n streams together; digest i lands at out + 32*i
+    inline void finalMany(Hasher* const* hs, size_t n, unsigned char* out) {
+        vector<unsigned char> tails(n * 72, 0);
+        vector<const unsigned char*> ptrs(n);
+        vector<size_t> lens(n);
+        for (size_t i = 0; i < n; i++) {
+            uint64 totalBitLen = hs[i]->bitlen + hs[i]->bufferLen * 8;
+            unsigned char* t = tails.data() + i * 72;
+            size_t padLen = (hs[i]->bufferLen < 56 ? 56 : 120) - hs[i]->bufferLen;
+            t[0] = 0x80;
+            for (int b = 0; b < 8; b++) t[padLen + b] = (unsigned char)(totalBitLen >> ((7 - b) * 8));
+            ptrs[i] = t; lens[i] = padLen + 8;
+        }
+        updateMany(hs, ptrs.data(), lens.data(), n);
+        for (size_t i = 0; i < n; i++)
+            for (int j = 0; j < 8; j++) {
+                uint32 v = hs[i]->states[j];
+                unsigned char* o = out + i*32 + j*4;
+                o[0] = (unsigned char)(v >> 24); o[1] = (unsigned char)(v >> 16);
+                o[2] = (unsigned char)(v >> 8); o[3] = (unsigned char)v;
+            }
+    }
+    // One-shot digests of independent messages (e.g. candidate blocks while mining)
+    inline vector<vector<unsigned char>> hashMany(const vector<string>& msgs) {
+        size_t n = msgs.size();
+        vector<Hasher> hs(n);
+        vector<Hasher*> hp(n);
+        vector<const unsigned char*> ptrs(n);
+        vector<size_t> lens(n);
+        for (size_t i = 0; i < n; i++) {
+            hp[i] = &hs[i]; ptrs[i] = (const unsigned char*)msgs[i].data(); lens[i] = msgs[i].size();
+        }
+        updateMany(hp.data(), ptrs.data(), lens.data(), n);
+        vector<unsigned char> raw(n * 32);
+        finalMany(hp.data(), n, raw.data());
+        vector<vector<unsigned char>> res(n);
+        for (size_t i = 0; i < n; i++) res[i].assign(raw.begin() + i*32, raw.begin() + i*32 + 32);
+        return res;
+    }
+
+    static inline vector<unsigned char> hash(const unsigned char* data, size_t len) {
+        Hasher h;
+        h.update(data, len);
+        return h.final();
+    }
+    static inline vector<unsigned char> hash(const string& s) {
+        return hash((const unsigned char*)s.data(), s.size());
+    }
+    static string toHex(const vector<unsigned char>& h) {
+        stringstream ss;
+        for (auto b : h) ss << hex << setfill('0') << setw(2) << (int)b;
+        return ss.str();
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════
+// Work-Stealing Pool
+// Runs tasks on a fixed set of threads. Every thread owns a
+// deque, seeded round-robin in the caller's order (callers put
+// the biggest tasks first). Owners take from the front, so large
+// work starts early; an idle thread steals from the back of a
+// peer's deque, which evens out the tail with the small tasks.
+// With a refill source (e.g. a DirWalker) a thread that finds
+// nothing to steal pulls the next batch into its own deque, so
+// tasks can stream in while the first ones already run.
+// While tasks run, concurrentJobs() tells parallelFor how many
+// share the cores.
+// Included by Crypt-Vault.cpp after crypto_utils.h.
+// ═══════════════════════════════════════════════════════════
+#include <deque>
+#include <mutex>
+
+template <class Task>
+class WorkStealingPool {
+    struct Queue {
+        mutex m;
+        deque<Task> tasks;
+    };
+public:
+    // Next tasks from a stream, called by one thread at a time; false once it is exhausted
+    using Refill = function<bool(vector<Task>& batch)>;
+
+    // fn(worker, task) once per task; worker is in [0, threads)
+    static void run(vector<Task> seed, size_t threads, const function<void(size_t, Task&)>& fn,
+                    const Refill& refill = nullptr) {
+        if (seed.empty() && !refill) return;
+        threads = max((size_t)1, refill ? threads : min(threads, seed.size()));
+        vector<Queue> queues(threads);
+        for (size_t i = 0; i < seed.size(); i++) queues[i % threads].tasks.push_back(std::move(seed[i]));
+        mutex sourceLock;
+        bool exhausted = !refill;
+
+        auto pop = [&](Queue& q, bool front, Task& task) {
+            lock_guard<mutex> g(q.m);
+            if (q.tasks.empty()) return false;
+            if (front) { task = std::move(q.tasks.front()); q.tasks.pop_front(); }
+            else { task = std::move(q.tasks.back()); q.tasks.pop_back(); }
+            return true;
+        };
+        auto take = [&](size_t self, Task& task) {
+            for (;;) {
+                if (pop(queues[self], true, task)) return true;
+                for (size_t k = 1; k < threads; k++)
+                    if (pop(queues[(self + k) % threads], false, task)) return true;
+                vector<Task> batch;
+                {
+                    lock_guard<mutex> g(sourceLock);
+                    if (exhausted) return false;   // tasks never spawn tasks: nothing left anywhere
+                    exhausted = !refill(batch);
+                }
+                lock_guard<mutex> g(queues[self].m);
+                for (auto& t : batch) queues[self].tasks.push_back(std::move(t));
+            }
+        };
+        auto worker = [&](size_t self) {
+            Task task;
+            while (take(self, task)) {
+                concurrentJobs()++;
+                fn(self, task);
+                concurrentJobs()--;
+            }
+        };
+        if (threads == 1) { worker(0); return; }
+        vector<thread> pool;
+        for (size_t w = 0; w < threads; w++) pool.emplace_back(worker, w);
+        for (auto& t : pool) t.join();
+    }
+};
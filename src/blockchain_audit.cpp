@@ -1,5 +1,6 @@
 #include "../include/blockchain_audit.h"
 #include "../include/p2p_node.h"
+#include "../include/crypto_utils.h"
 #include "eth_logger.hpp"
 #include <algorithm>
 #include <iostream>
@@ -14,62 +15,18 @@ extern std::unique_ptr<EthLogger> ethLogger;
 using namespace std;
 
 // ─────────────────────────────────────────────────────────────
-//  SHA-256 IMPLEMENTATION
+//  SHA-256 (shared implementation)
 // ─────────────────────────────────────────────────────────────
 
 namespace AuditSHA256 {
-    typedef unsigned int uint32;
-    typedef unsigned long long uint64;
-
-    static const uint32 K[64] = {
-        0x428a2f98,0x71374491,0xb5c0fbcf,0xe9b5dba5,0x3956c25b,0x59f111f1,0x923f82a4,0xab1c5ed5,
-        0xd807aa98,0x12835b01,0x243185be,0x550c7dc3,0x72be5d74,0x80deb1fe,0x9bdc06a7,0xc19bf174,
-        0xe49b69c1,0xefbe4786,0x0fc19dc6,0x240ca1cc,0x2de92c6f,0x4a7484aa,0x5cb0a9dc,0x76f988da,
-        0x983e5152,0xa831c66d,0xb00327c8,0xbf597fc7,0xc6e00bf3,0xd5a79147,0x06ca6351,0x14292967,
-        0x27b70a85,0x2e1b2138,0x4d2c6dfc,0x53380d13,0x650a7354,0x766a0abb,0x81c2c92e,0x92722c85,
-        0xa2bfe8a1,0xa81a664b,0xc24b8b70,0xc76c51a3,0xd192e819,0xd6990624,0xf40e3585,0x106aa070,
-        0x19a4c116,0x1e376c08,0x2748774c,0x34b0bcb5,0x391c0cb3,0x4ed8aa4a,0x5b9cca4f,0x682e6ff3,
-        0x748f82ee,0x78a5636f,0x84c87814,0x8cc70208,0x90befffa,0xa4506ceb,0xbef9a3f7,0xc67178f2
-    };
-
-    inline uint32 rotr(uint32 x, int n) { return (x >> n) | (x << (32 - n)); }
-    inline uint32 ch(uint32 x, uint32 y, uint32 z) { return (x & y) ^ (~x & z); }
-    inline uint32 maj(uint32 x, uint32 y, uint32 z) { return (x & y) ^ (x & z) ^ (y & z); }
-    inline uint32 sig0(uint32 x) { return rotr(x, 2) ^ rotr(x, 13) ^ rotr(x, 22); }
-    inline uint32 sig1(uint32 x) { return rotr(x, 6) ^ rotr(x, 11) ^ rotr(x, 25); }
-    inline uint32 gam0(uint32 x) { return rotr(x, 7) ^ rotr(x, 18) ^ (x >> 3); }
-    inline uint32 gam1(uint32 x) { return rotr(x, 17) ^ rotr(x, 19) ^ (x >> 10); }
-
+    // Through the provider layer; mining batches stay on SHA256Impl::hashMany lanes
     string hash(const string& input) {
-        uint32 h[8] = {0x6a09e667,0xbb67ae85,0x3c6ef372,0xa54ff53a,0x510e527f,0x9b05688c,0x1f83d9ab,0x5be0cd19};
-        uint64 bitlen = (uint64)input.size() * 8;
-
-        vector<unsigned char> msg(input.begin(), input.end());
-        msg.push_back(0x80);
-        while ((msg.size() % 64) != 56) msg.push_back(0x00);
-        for (int i = 7; i >= 0; i--) msg.push_back((unsigned char)(bitlen >> (i * 8)));
-
-        for (size_t off = 0; off < msg.size(); off += 64) {
-            uint32 w[64];
-            for (int i = 0; i < 16; i++)
-                w[i] = ((uint32)msg[off+i*4]<<24)|((uint32)msg[off+i*4+1]<<16)|((uint32)msg[off+i*4+2]<<8)|msg[off+i*4+3];
-            for (int i = 16; i < 64; i++)
-                w[i] = gam1(w[i-2]) + w[i-7] + gam0(w[i-15]) + w[i-16];
-
-            uint32 a=h[0],b=h[1],c=h[2],d=h[3],e=h[4],f=h[5],g=h[6],hh=h[7];
-            for (int i = 0; i < 64; i++) {
-                uint32 t1 = hh + sig1(e) + ch(e,f,g) + K[i] + w[i];
-                uint32 t2 = sig0(a) + maj(a,b,c);
-                hh=g; g=f; f=e; e=d+t1; d=c; c=b; b=a; a=t1+t2;
-            }
-            h[0]+=a;h[1]+=b;h[2]+=c;h[3]+=d;h[4]+=e;h[5]+=f;h[6]+=g;h[7]+=hh;
-        }
-
-        stringstream ss;
-        for (int i = 0; i < 8; i++) {
-            ss << hex << setw(8) << setfill('0') << h[i];
+        unsigned char digest[32];
+        if (!CryptoProvider::sha256((const unsigned char*)input.data(), input.size(), digest)) {
+            auto native = SHA256Impl::hash((const unsigned char*)input.data(), input.size());
+            return bytesToHex(native.data(), 32);   // the native kernel cannot fail
         }
-        return ss.str();
+        return bytesToHex(digest, 32);
     }
 }
 
@@ -122,13 +79,24 @@ string CryptVaultBlockchain::getDeviceID() {
 
 string CryptVaultBlockchain::mineBlock(Block& block) {
     string target(difficulty, '0');
-    block.nonce = 0;
-    string hash;
-    do {
-        block.nonce++;
-        hash = AuditSHA256::hash(block.toString());
-    } while (hash.substr(0, difficulty) != target);
-    return hash;
+    // Candidate nonces are hashed a batch at a time in SIMD lanes;
+    // the lowest qualifying nonce wins, as with one-by-one search
+    size_t batch = SHA256Impl::multiLanes();
+    vector<string> candidates(batch);
+    for (long long base = 1; ; base += (long long)batch) {
+        for (size_t i = 0; i < batch; i++) {
+            block.nonce = base + (long long)i;
+            candidates[i] = block.toString();
+        }
+        auto digests = SHA256Impl::hashMany(candidates);
+        for (size_t i = 0; i < batch; i++) {
+            string hash = SHA256Impl::toHex(digests[i]);
+            if (hash.compare(0, difficulty, target) == 0) {
+                block.nonce = base + (long long)i;
+                return hash;
+            }
+        }
+    }
 }
 
 Block CryptVaultBlockchain::createGenesisBlock() {